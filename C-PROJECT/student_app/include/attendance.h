@@ -6,6 +6,9 @@
 #include <string.h>
 #include <time.h>
 #include "config.h"
+#include "free_slots.h"
+#include "hash_index.h"
+#include "attendance_bitmap.h"
 
 // Attendance record structure
 typedef struct {
@@ -19,26 +22,91 @@ typedef struct {
     time_t recorded_time;
 } AttendanceRecord;
 
+// Running marked/attended session counts per student or per course id
+typedef struct {
+    int* ids;
+    int* marked;            // (Session, student) pairs with a live record
+    int* attended;          // Of those, present or late at least once
+    int count;
+    int capacity;
+    HashIndex index;        // Id -> entry
+} AttendanceTallyTable;
+
+// Totals over the live records, adjusted by every write so the stats view
+// never has to rescan the history. The record counts move with each record;
+// the per-student and per-course tables move with the session bits of the
+// list's bitmap, so a student marked twice in one session counts once.
+typedef struct {
+    int total;                     // Live records
+    int by_status[4];              // Indexed by ATTENDANCE_* status
+    int month_marked[12];          // By month of the session date
+    int month_attended[12];
+    AttendanceTallyTable students;
+    AttendanceTallyTable courses;
+    int perfect_students;          // Marked for a session, attended every one
+    int poor_students;             // Attended below POOR_ATTENDANCE_RATE of their sessions
+    int stale;                     // An update could not be applied; recount before use
+} AttendanceTally;
+
 // Attendance list structure
 typedef struct {
     AttendanceRecord* records;
-    int count;
+    int count;              // Slots in use, tombstones included
     int capacity;
+    FreeSlots free_slots;   // Tombstoned slots below count
+    int next_id;            // Next id handed out by mark_attendance; never reused
+    HashIndex id_index;           // Record id -> position in records
+    HashIndex student_day_index;  // (student_id, day recorded) -> position in records
+    HashIndex course_day_index;   // (course_id, day of date) -> position in records
+    AttendanceTally tally;        // Running totals over the live records
+    AttendanceBitmap bitmap;      // Per-course session bitsets over the live records
 } AttendanceList;
 
+// One student's mark for mark_attendance_session
+typedef struct {
+    int student_id;
+    int status;
+} AttendanceMark;
+
+// Walks the records of one course session by reference, straight off
+// course_day_index. Records come back in index order, not storage order,
+// and the pointers stay valid only until the list is next modified.
+typedef struct {
+    AttendanceList* list;
+    HashIndexProbe probe;
+    int course_id;
+    time_t date;
+} AttendanceDateIterator;
+
 // Attendance management functions
 AttendanceList* attendance_list_create(void);
 void attendance_list_destroy(AttendanceList* list);
 int attendance_list_add(AttendanceList* list, AttendanceRecord record);
 int attendance_list_remove(AttendanceList* list, int record_id);
+void attendance_list_compact(AttendanceList* list);
 AttendanceRecord* attendance_list_find_by_id(AttendanceList* list, int record_id);
 AttendanceRecord* attendance_list_find_by_student_date(AttendanceList* list, int student_id, time_t date);
 AttendanceRecord* attendance_list_find_by_course_date(AttendanceList* list, int course_id, time_t date);
 
 // Attendance operations
 int mark_attendance(AttendanceList* list, int student_id, int course_id, time_t date, int status, int teacher_id);
+int mark_attendance_many(AttendanceList* list, const AttendanceRecord* marks, int count);
+int mark_attendance_session(AttendanceList* list, int course_id, time_t date, int teacher_id, const AttendanceMark* marks, int count);
 int update_attendance(AttendanceList* list, int record_id, int new_status, const char* reason);
 int get_attendance_for_date(AttendanceList* list, int course_id, time_t date, AttendanceRecord** records, int* count);
+void attendance_date_iter_begin(AttendanceList* list, int course_id, time_t date, AttendanceDateIterator* iter);
+AttendanceRecord* attendance_date_iter_next(AttendanceDateIterator* iter);
+int attendance_day(time_t t);
+
+// Running totals, O(1) to read
+const AttendanceTally* attendance_list_tally(AttendanceList* list);
+float attendance_student_rate(AttendanceList* list, int student_id);
+float attendance_course_rate(AttendanceList* list, int course_id);
+
+// Roll call and per-session rates, off the course bitmaps
+int attendance_roll_call(AttendanceList* list, int course_id, time_t date, int* student_ids, int max_count);
+float attendance_session_rate(AttendanceList* list, int course_id, time_t date);
+float attendance_student_course_rate(AttendanceList* list, int student_id, int course_id);
 
 // Attendance display
 void attendance_list_display_all(AttendanceList* list);
@@ -48,6 +116,20 @@ void attendance_display_record(AttendanceRecord* record);
 int attendance_list_save_to_file(AttendanceList* list, const char* filename);
 int attendance_list_load_from_file(AttendanceList* list, const char* filename);
 
+// On-disk format, identical on every platform: a 32-byte header, then
+// count fixed 240-byte records, all integers little-endian.
+//   header: magic[8], version, record size, count, next_id,
+//           Adler-32 of the records, Adler-32 of the preceding 28 bytes
+//   record: id, student_id, course_id, status, teacher_id, reserved (int32),
+//           date, recorded_time (int64), reason[200] (NUL-padded)
+#define ATTENDANCE_FILE_MAGIC "ATTLIST"
+#define ATTENDANCE_FILE_VERSION 1
+#define ATTENDANCE_FILE_HEADER_SIZE 32
+#define ATTENDANCE_FILE_RECORD_SIZE 240
+
+// Room an empty list starts with, and the headroom left after a load
+#define ATTENDANCE_LIST_MIN_CAPACITY 40
+
 // Attendance constants
 #define ATTENDANCE_ABSENT 0
 #define ATTENDANCE_PRESENT 1
@@ -0,0 +1,65 @@
+#ifndef ATTENDANCE_BITMAP_H
+#define ATTENDANCE_BITMAP_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "hash_index.h"
+
+// Bitmap index over attendance, one roster per course: every student marked
+// in the course gets a bit position on that roster, and every session (day
+// the course met) gets two bitsets as wide as the roster, one for the
+// students marked at all and one for those who attended (present or late).
+// Roll-call and rate questions become popcounts over a handful of words.
+// The owning list keeps it up to date on every write.
+typedef struct {
+    int course_id;
+    int* students;              // Student id per bit position
+    int student_count;
+    int student_capacity;
+    HashIndex student_index;    // Student id -> bit position
+
+    int* days;                  // attendance_day of each session
+    int session_count;
+    int session_capacity;
+    HashIndex session_index;    // Day -> session
+
+    int words;                  // 64-bit words per bitset, grown with the roster
+    uint64_t* marked;           // session_capacity bitsets of words each
+    uint64_t* attended;
+} AttendanceRoster;
+
+typedef struct {
+    AttendanceRoster* rosters;
+    int roster_count;
+    int roster_capacity;
+    HashIndex roster_index;     // Course id -> roster
+    int stale;                  // A write could not be applied; rebuild before use
+} AttendanceBitmap;
+
+// A student's standing in one session
+#define ATTENDANCE_BITMAP_MARKED 1
+#define ATTENDANCE_BITMAP_ATTENDED 2
+
+// Index management functions
+void attendance_bitmap_init(AttendanceBitmap* bitmap);
+void attendance_bitmap_free(AttendanceBitmap* bitmap);
+
+// Writes return the student's previous flags in the session, or -1 when out
+// of memory
+int attendance_bitmap_add(AttendanceBitmap* bitmap, int course_id, int day, int student_id, int flags);
+int attendance_bitmap_set(AttendanceBitmap* bitmap, int course_id, int day, int student_id, int flags);
+
+// Session queries; day is an attendance_day
+int attendance_bitmap_flags(const AttendanceBitmap* bitmap, int course_id, int day, int student_id);
+int attendance_bitmap_session_counts(const AttendanceBitmap* bitmap, int course_id, int day, int* marked, int* attended);
+int attendance_bitmap_attended_students(const AttendanceBitmap* bitmap, int course_id, int day, int* student_ids, int max_count);
+
+// Sessions of the course the student was marked for and attended
+int attendance_bitmap_student_sessions(const AttendanceBitmap* bitmap, int course_id, int student_id, int* marked, int* attended);
+
+// Rate over every session of the course in percent, or -1 when there is
+// nothing to measure
+float attendance_bitmap_course_rate(const AttendanceBitmap* bitmap, int course_id);
+
+#endif // ATTENDANCE_BITMAP_H
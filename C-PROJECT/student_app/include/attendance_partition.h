@@ -0,0 +1,58 @@
+#ifndef ATTENDANCE_PARTITION_H
+#define ATTENDANCE_PARTITION_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "attendance.h"
+#include "utils.h"
+
+// Attendance history split by the month of the session date. Each month is
+// its own AttendanceList, with its own file and date indexes, and is loaded
+// only when a query or write reaches it, so recent dates never touch old
+// months. Months can be archived: they are then kept in the columnar
+// AttendanceStore format, about a tenth of the size, and converted back on
+// load. A small text manifest in the directory lists the months.
+//
+//   <directory>/attendance.parts          manifest
+//   <directory>/attendance-YYYYMM.dat     hot month, attendance_list format
+//   <directory>/attendance-YYYYMM.cold    archived month, attendance_store format
+#define ATTENDANCE_PARTITION_MAGIC "ATTPARTS"
+#define ATTENDANCE_PARTITION_VERSION 1
+#define ATTENDANCE_PARTITION_MANIFEST "attendance.parts"
+
+typedef struct {
+    int month;               // yyyymm of the session dates it holds
+    int archived;            // Saved in the columnar cold format
+    int dirty;               // list has changes not yet saved
+    AttendanceList* list;    // Loaded records, or NULL until first needed
+} AttendancePartition;
+
+typedef struct {
+    char directory[UTILS_MAX_PATH_LENGTH];
+    AttendancePartition* partitions;   // Ascending by month
+    int count;
+    int capacity;
+    int next_id;                       // Id sequence shared by every month
+} AttendancePartitionSet;
+
+// Set management functions
+int attendance_partitions_open(AttendancePartitionSet* set, const char* directory);
+int attendance_partitions_save(AttendancePartitionSet* set);
+void attendance_partitions_free(AttendancePartitionSet* set);
+int attendance_partitions_import(AttendancePartitionSet* set, AttendanceList* list);
+
+// The month holding date, loaded on demand; NULL if there is none
+AttendanceList* attendance_partitions_month(AttendancePartitionSet* set, time_t date);
+
+// Attendance operations, routed to the month of date
+int attendance_partitions_mark(AttendancePartitionSet* set, int student_id, int course_id, time_t date, int status, int teacher_id);
+int attendance_partitions_update(AttendancePartitionSet* set, time_t date, int record_id, int new_status, const char* reason);
+int attendance_partitions_remove(AttendancePartitionSet* set, time_t date, int record_id);
+int attendance_partitions_for_date(AttendancePartitionSet* set, int course_id, time_t date, AttendanceRecord** records, int* count);
+
+// Months that end before cutoff
+int attendance_partitions_archive_before(AttendancePartitionSet* set, time_t cutoff);
+int attendance_partitions_unload_before(AttendancePartitionSet* set, time_t cutoff);
+
+#endif // ATTENDANCE_PARTITION_H
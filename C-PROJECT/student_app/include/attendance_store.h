@@ -0,0 +1,90 @@
+#ifndef ATTENDANCE_STORE_H
+#define ATTENDANCE_STORE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "attendance.h"
+#include "hash_index.h"
+
+// Column-oriented attendance storage, about a tenth of the size of an
+// AttendanceRecord array. Each row is split over narrow columns:
+//  - course and teacher ids become 16-bit references into small dictionaries
+//  - the session date becomes a 16-bit day offset from the course's first
+//    day plus a seconds-of-day value sharing a word with the 2-bit status
+//  - recorded_time is kept as a 32-bit offset from the session date
+//  - reasons live in a side string pool, listed only for rows that have one
+// Every field round-trips exactly; rows that cannot be encoded are refused.
+// The same columns, written back to back, are the on-disk format.
+#define ATTENDANCE_STORE_MAGIC "ATTCOLS"
+#define ATTENDANCE_STORE_VERSION 1
+#define ATTENDANCE_STORE_MAX_REFS 65535     // Distinct courses or teachers
+#define ATTENDANCE_STORE_STATUS_BITS 2
+#define ATTENDANCE_STORE_STATUS_MASK ((1u << ATTENDANCE_STORE_STATUS_BITS) - 1)
+
+typedef struct {
+    int count;                       // Rows stored
+    int capacity;                    // Room in each row column
+    int* ids;
+    int* student_ids;
+    unsigned short* course_refs;     // Index into courses
+    unsigned short* teacher_refs;    // Index into teachers
+    short* day_offsets;              // Session day minus the course's base day
+    unsigned int* time_status;       // Seconds into the day << 2 | status
+    int* recorded_offsets;           // recorded_time minus the session date
+
+    int* courses;                    // Course id per reference
+    int* course_base_days;           // Day number of the course's first row
+    int course_count;
+    int course_capacity;
+    HashIndex course_index;          // Course id -> reference
+
+    int* teachers;                   // Teacher id per reference
+    int teacher_count;
+    int teacher_capacity;
+    HashIndex teacher_index;         // Teacher id -> reference
+
+    int* reason_rows;                // Rows with a reason, ascending
+    int* reason_offsets;             // Start of each row's reason in reasons
+    int reason_count;
+    int reason_capacity;
+    char* reasons;                   // NUL-terminated strings back to back
+    size_t reasons_size;
+    size_t reasons_capacity;
+
+    int next_id;                     // AttendanceList.next_id at conversion
+} AttendanceStore;
+
+typedef struct {
+    char magic[8];                   // ATTENDANCE_STORE_MAGIC, NUL-padded
+    unsigned int byte_order;         // 0x01020304 as written by the saving machine
+    unsigned int version;            // ATTENDANCE_STORE_VERSION
+    int count;
+    int course_count;
+    int teacher_count;
+    int reason_count;
+    unsigned int reasons_size;
+    int next_id;
+    unsigned int checksum;           // Adler-32 of everything after the header
+    unsigned int reserved;
+} AttendanceStoreHeader;
+
+// Store management functions
+void attendance_store_init(AttendanceStore* store);
+void attendance_store_free(AttendanceStore* store);
+int attendance_store_append(AttendanceStore* store, const AttendanceRecord* record);
+int attendance_store_get(const AttendanceStore* store, int row, AttendanceRecord* record);
+int attendance_store_status(const AttendanceStore* store, int row);
+time_t attendance_store_date(const AttendanceStore* store, int row);
+const char* attendance_store_reason(const AttendanceStore* store, int row);
+size_t attendance_store_memory(const AttendanceStore* store);
+
+// Conversion to and from the record list
+int attendance_store_from_list(AttendanceStore* store, AttendanceList* list);
+int attendance_store_to_list(const AttendanceStore* store, AttendanceList* list);
+
+// File operations
+int attendance_store_save(const AttendanceStore* store, const char* filename);
+int attendance_store_load(AttendanceStore* store, const char* filename);
+
+#endif // ATTENDANCE_STORE_H
@@ -6,6 +6,8 @@
 #include <string.h>
 #include <time.h>
 #include "config.h"
+#include "free_slots.h"
+#include "hash_index.h"
 
 // Club structure
 typedef struct {
@@ -39,15 +41,19 @@ typedef struct {
 // Club list structure
 typedef struct {
     Club* clubs;
-    int count;
+    int count;              // Slots in use, tombstones included
     int capacity;
+    FreeSlots free_slots;   // Tombstoned slots below count
+    HashIndex id_index;     // Club id -> position in clubs
 } ClubList;
 
 // Membership list structure
 typedef struct {
     ClubMembership* memberships;
-    int count;
+    int count;              // Slots in use, tombstones included
     int capacity;
+    FreeSlots free_slots;   // Tombstoned slots below count
+    HashIndex id_index;     // Membership id -> position in memberships
 } MembershipList;
 
 // Principal Club management functions
@@ -55,6 +61,7 @@ ClubList* club_list_create(void);
 void club_list_destroy(ClubList* list);
 int club_list_add(ClubList* list, Club club);
 int club_list_remove(ClubList* list, int club_id);
+void club_list_compact(ClubList* list);
 Club* club_list_find_by_id(ClubList* list, int club_id);
 Club* club_list_find_by_name(ClubList* list, const char* name);
 void club_list_display_all(ClubList* list);
@@ -65,6 +72,7 @@ MembershipList* membership_list_create(void);
 void membership_list_destroy(MembershipList* list);
 int membership_list_add(MembershipList* list, ClubMembership membership);
 int membership_list_remove(MembershipList* list, int membership_id);
+void membership_list_compact(MembershipList* list);
 ClubMembership* membership_list_find_by_id(MembershipList* list, int membership_id);
 
 // Principal Membership operations
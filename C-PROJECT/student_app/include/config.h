@@ -5,6 +5,7 @@
 #define APP_NAME "Student Management System"
 #define APP_VERSION "1.0.0"
 #define MAX_STUDENTS 1000
+#define AUTO_SAVE_INTERVAL_SECONDS 30
 #define MAX_NAME_LENGTH 100
 #define MAX_EMAIL_LENGTH 150
 #define MAX_PHONE_LENGTH 20
@@ -12,6 +13,7 @@
 #define MAX_COURSE_LENGTH 50
 #define MAX_CLUB_LENGTH 50
 #define MAX_CLUBS 15 
+#define POOR_ATTENDANCE_RATE 75.0f   // Percent of sessions attended
 // File paths
 #define DATA_DIR "data/"
 #define STUDENTS_FILE "students.enc"
@@ -0,0 +1,30 @@
+#ifndef FREE_SLOTS_H
+#define FREE_SLOTS_H
+
+#include <limits.h>
+#include <stdlib.h>
+
+// Tombstone deletion support for the record lists. A removed record stays
+// in its slot with its id set to TOMBSTONE_ID, so removal never shifts the
+// records behind it. The slot is pushed here and reused by the next add;
+// a compaction pass squeezes the tombstones out once they pile up.
+#define TOMBSTONE_ID INT_MIN
+
+// Compact once more than half of the slots (and at least this many) are dead
+#define FREE_SLOTS_COMPACT_MIN 32
+
+typedef struct {
+    int* slots;
+    int count;
+    int capacity;
+} FreeSlots;
+
+// Free slot management functions
+void free_slots_init(FreeSlots* free_slots);
+void free_slots_free(FreeSlots* free_slots);
+void free_slots_clear(FreeSlots* free_slots);
+int free_slots_push(FreeSlots* free_slots, int slot);
+int free_slots_pop(FreeSlots* free_slots);
+int free_slots_should_compact(const FreeSlots* free_slots, int slot_count);
+
+#endif // FREE_SLOTS_H
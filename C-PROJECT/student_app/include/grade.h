@@ -7,6 +7,8 @@
 #include <time.h>
 #include "config.h"
 #include "crypto.h"
+#include "free_slots.h"
+#include "hash_index.h"
 typedef struct {
     int id;
     char nom[MAX_NAME_LENGTH];
@@ -23,6 +25,8 @@ typedef struct {
     Module* cours;
     int count;
     int capacity;
+    FreeSlots free_slots;
+    HashIndex index; // id -> position in cours
     char filename[256];
 } ListeModules;
 typedef struct {
@@ -36,6 +40,7 @@ typedef struct {
     Examen* exam;
     int count;
     int capacity;
+    FreeSlots free_slots;
     char filename[256];
 }liste_examen;
 typedef struct {
@@ -48,14 +53,46 @@ typedef struct {
 Note *note;
 int count;
 int capacity;
+FreeSlots free_slots;
+HashIndex index; // (id_etudiant, id_examen) -> position in note
 char file_name[256];
 }liste_note;
+// Totals over the grades of one student or one exam
+typedef struct {
+    int id;            // id_etudiant or id_examen
+    int presents;      // Grades with present == 1
+    int absents;
+    double somme;      // Sum of the grades of those present
+    float min;
+    float max;
+    int admis;         // Present with a grade >= 10
+} NoteAgregat;
+// Aggregates by id, filled by note_grouper
+typedef struct {
+    NoteAgregat* groupes;
+    int count;
+    int capacity;
+    HashIndex index;   // id -> position in groupes
+} NoteGroupes;
+// Binary grade file, written by sauvegarder_notes_binaire to its own path
+// (NOTES_FICHIER_BINAIRE by default, never the text file) and recognised by
+// charger_notes_depuis_file when file_name points at it: a 16-byte header
+// (magic[8], version, count), count 16-byte records (id_etudiant, id_examen,
+// IEEE bits of note_obtenue, present), then the Adler-32 of the records;
+// all little-endian
+#define NOTES_FICHIER_BINAIRE "liste_des_notes.bin"
+#define NOTES_FICHIER_MAGIC "NOTESBN"
+#define NOTES_FICHIER_VERSION 1
+#define NOTES_FICHIER_ENTETE 16
+#define NOTES_FICHIER_ENREGISTREMENT 16
+#define NOTES_FICHIER_BLOC 256
 //fct examen
 Examen* creer_examen();
 void afficher_examen(Examen *E);
 int examen_ajouter(liste_examen* liste, Examen *ex);
 int examen_supprimer_par_id(liste_examen* liste,int id_examen);
 int examen_supprimer_par_nom(liste_examen* liste,char* nom_examen);
+void liste_examen_compacter(liste_examen* liste);
 void afficher_liste_examens(liste_examen *liste) ;
 liste_examen* cree_liste_examen();
 Examen* chercher_examen_par_id(liste_examen* liste,int id);
@@ -63,12 +100,13 @@ Examen* chercher_examen_par_nom(liste_examen* liste,char* nom);
 void modidier_examen(liste_examen liste);
 int sauvegarder_liste_examen_ds_file(liste_examen *liste);
 int liste_examen_a_partir_file(liste_examen *liste);
-int trie_liste_examen_id(liste_examen liste ,int n );
-int trie_liste_examen_nom(int n,liste_examen liste);
+int trie_liste_examen_id(liste_examen *liste ,int n );
+int trie_liste_examen_nom(int n,liste_examen *liste);
 //fct note
 liste_note* creer_liste_note(int capacite);
 Note* cree_note() ;
 int note_ajouter(liste_note *liste, Note *n);
+int note_ajouter_plusieurs(liste_note *liste, const Note *notes, int n);
 void afficher_note(Note *n);
 void afficher_liste_notes(liste_note *liste);
 Note* chercher_note(liste_note *liste, int id_etudiant, int id_examen);
@@ -76,13 +114,24 @@ void afficher_notes_etudiant(liste_note *liste, int id_etudiant);
 void afficher_notes_examen(liste_note *liste, int id_examen);
 void modifier_note(liste_note *liste);
 int note_supprimer(liste_note *liste, int id_etudiant, int id_examen);
+void liste_note_compacter(liste_note *liste);
 float calculer_moyenne_etudiant(liste_note *liste, int id_etudiant);
 float calculer_moyenne_examen(liste_note *liste, int id_examen);
 void statistiques_examen(liste_note *liste, int id_examen);
 int sauvegarder_notes_ds_file(liste_note *liste);
+int sauvegarder_notes_binaire(liste_note *liste, const char *chemin);
 int charger_notes_depuis_file(liste_note *liste);
 void trier_notes_par_etudiant(liste_note *liste);
 void detruire_liste_notes(liste_note **liste);
+//fct agregation
+void note_groupes_init(NoteGroupes *groupes);
+void note_groupes_liberer(NoteGroupes *groupes);
+int note_grouper(liste_note *liste, NoteGroupes *par_etudiant, NoteGroupes *par_examen);
+NoteAgregat* note_groupes_chercher(NoteGroupes *groupes, int id);
+float note_agregat_moyenne(const NoteAgregat *agregat);
+//fct classement
+int note_classement_examen(liste_note *liste, int id_examen, int k, int *meilleurs, int *derniers);
+int note_classement_module(liste_note *liste, liste_examen *examens, int id_module, int k, int *meilleurs, int *derniers);
 //fct module
  Module* cree_module();
  ListeModules* liste_cours_creer();
@@ -90,6 +139,7 @@ void detruire_liste_notes(liste_note **liste);
  int cours_ajouter(ListeModules* liste, Module cours);
  int cours_supprimer_par_nom(ListeModules* liste, char* cours_nom);
  int cours_supprimer_par_id(ListeModules *liste, int cours_id);
+ void liste_cours_compacter(ListeModules* liste);
  Module* cours_rechercher_par_id(ListeModules* liste, int cours_id);
  void cours_afficher(Module* m);
  void liste_cours_afficher(ListeModules* liste);
@@ -97,10 +147,10 @@ void detruire_liste_notes(liste_note **liste);
  void cours_afficher_depuis_un_liste_par_nom(ListeModules liste,char *nom);
  Module* chercher_module_par_nom(ListeModules liste,char* nom);
  Module* chercher_module_par_id(ListeModules liste,int id);
- void modidier_cours(ListeModules liste);
+ void modidier_cours(ListeModules *liste);
  int sauvegarder_modules_ds_file(ListeModules liste);
  int remplire_liste_appartit_file(ListeModules *liste);
- int trie_liste_id(ListeModules liste ,int n );
- int trie_par_nom(int n,ListeModules liste);
+ int trie_liste_id(ListeModules *liste ,int n );
+ int trie_par_nom(int n,ListeModules *liste);
  void liste_cours_niveau(ListeModules liste,int niveaux);
  void liste_cours_filiere(ListeModules liste,int filiere);
\ No newline at end of file
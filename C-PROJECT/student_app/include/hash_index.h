@@ -0,0 +1,45 @@
+#ifndef HASH_INDEX_H
+#define HASH_INDEX_H
+
+#include <stdlib.h>
+
+// Open-addressing hash index mapping a key hash to a record slot.
+// Keys are not stored: lookups yield candidate slots whose hash matches,
+// and the caller confirms the candidate against its own record.
+typedef struct {
+    unsigned long hash;
+    int slot;         // Record slot, HASH_INDEX_EMPTY or HASH_INDEX_DELETED
+} HashIndexEntry;
+
+typedef struct {
+    HashIndexEntry* entries;
+    int capacity;     // Always zero or a power of two
+    int count;
+    int deleted;
+} HashIndex;
+
+// Iteration state over the candidates of a single hash
+typedef struct {
+    const HashIndex* index;
+    unsigned long hash;
+    unsigned long position;
+    int steps;
+} HashIndexProbe;
+
+#define HASH_INDEX_EMPTY -1
+#define HASH_INDEX_DELETED -2
+#define HASH_INDEX_MIN_CAPACITY 16
+
+// Index management functions
+void hash_index_init(HashIndex* index);
+void hash_index_free(HashIndex* index);
+void hash_index_clear(HashIndex* index);
+int hash_index_reserve(HashIndex* index, int expected_count);
+
+// Index operations
+int hash_index_insert(HashIndex* index, unsigned long hash, int slot);
+int hash_index_remove(HashIndex* index, unsigned long hash, int slot);
+void hash_index_probe_begin(const HashIndex* index, unsigned long hash, HashIndexProbe* probe);
+int hash_index_probe_next(HashIndexProbe* probe);
+
+#endif // HASH_INDEX_H
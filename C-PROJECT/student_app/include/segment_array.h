@@ -0,0 +1,30 @@
+#ifndef SEGMENT_ARRAY_H
+#define SEGMENT_ARRAY_H
+
+#include <stdlib.h>
+
+// Growable array stored as fixed-size segments. Growing only allocates new
+// segments and extends the segment table, so elements are never copied and
+// their addresses stay valid until the array is freed.
+typedef struct {
+    unsigned char** segments;
+    int segment_count;      // Segments allocated
+    int table_capacity;     // Room in segments[]
+    size_t element_size;
+} SegmentArray;
+
+#define SEGMENT_ARRAY_SHIFT 6
+#define SEGMENT_ARRAY_SIZE (1 << SEGMENT_ARRAY_SHIFT)   // Elements per segment
+
+// Array management functions
+void segment_array_init(SegmentArray* array, size_t element_size);
+void segment_array_free(SegmentArray* array);
+int segment_array_reserve(SegmentArray* array, int count);
+void segment_array_trim(SegmentArray* array, int count);
+int segment_array_capacity(const SegmentArray* array);
+
+// Element access; index must be below segment_array_capacity
+void* segment_array_at(const SegmentArray* array, int index);
+int segment_array_span(int index, int count);
+
+#endif // SEGMENT_ARRAY_H
@@ -0,0 +1,34 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include <stdlib.h>
+
+// Sorting works on a permutation of record positions (order[]), so large
+// records are only moved once, by sort_apply_permutation, or not at all.
+
+// Comparator over two record positions, returns <0, 0 or >0
+typedef int (*SortCompareFunc)(int a, int b, const void* context);
+
+// Address of the record at a position, for storage that is not one array
+typedef void* (*SortElementFunc)(int index, void* context);
+
+// Key conversions: unsigned order of the result matches numeric order
+unsigned int sort_key_from_int(int value);
+unsigned int sort_key_from_float(float value);
+
+// Permutation functions
+void sort_identity(int* order, int count);
+int sort_radix_indices(const unsigned int* keys, int* order, int count);
+int sort_merge_indices(int* order, int count, SortCompareFunc compare, const void* context);
+int sort_apply_permutation(void* base, size_t element_size, const int* order, int count);
+int sort_apply_permutation_at(SortElementFunc element, void* context, size_t element_size,
+                              const int* order, int count);
+
+// Selection: the k extreme positions by key, without sorting all of them.
+// Top is largest key first, ties to the lower position; bottom is smallest
+// key first, ties to the higher position, so both agree with a stable
+// descending sort read from either end. Both return how many were written.
+int sort_top_k_indices(const unsigned int* keys, int count, int k, int* out);
+int sort_bottom_k_indices(const unsigned int* keys, int count, int k, int* out);
+
+#endif // SORT_H
@@ -12,6 +12,9 @@
 #include "attendance.h"
 #include "club.h"
 
+// Students listed at each end of the GPA ranking
+#define STATS_RANKING_SIZE 10
+
 // General statistics structure
 typedef struct {
     int total_students;
@@ -34,8 +37,8 @@ typedef struct {
     int age_distribution[10];  // Age ranges
     float average_gpa;
     float gpa_distribution[5];  // GPA ranges
-    int top_performers[10];  // Top 10 student IDs
-    int struggling_students[10];  // Bottom 10 student IDs
+    int top_performers[STATS_RANKING_SIZE];  // Best first
+    int struggling_students[STATS_RANKING_SIZE];  // Worst last
 } StudentStats;
 
 // Grade statistics structure
@@ -6,6 +6,9 @@
 #include <string.h>
 #include <time.h>
 #include "config.h"
+#include "hash_index.h"
+#include "segment_array.h"
+#include "free_slots.h"
 
 // Student structure
 typedef struct {
@@ -23,32 +26,109 @@ typedef struct {
     int is_active;
 } Student;
 
+// Append-only journal of list mutations, replayed on top of the text file
+// (or its snapshot) on load and folded back into it by compaction
+#define STUDENT_JOURNAL_MAGIC "STUJRNL"
+#define STUDENT_JOURNAL_VERSION 1
+#define STUDENT_JOURNAL_SUFFIX ".journal"
+#define STUDENT_JOURNAL_COMPACT_SLACK 64   // Records tolerated beyond count / 2
+
+typedef enum {
+    STUDENT_JOURNAL_ADD = 1,
+    STUDENT_JOURNAL_UPDATE = 2,
+    STUDENT_JOURNAL_REMOVE = 3
+} StudentJournalOp;
+
+typedef struct {
+    char magic[8];              // STUDENT_JOURNAL_MAGIC, NUL-padded
+    unsigned int byte_order;    // 0x01020304 as written by the saving machine
+    unsigned int version;       // STUDENT_JOURNAL_VERSION
+    unsigned int record_size;   // sizeof(StudentJournalRecord)
+    unsigned int reserved;
+    long long base_size;        // Size of the text file the records apply to
+    long long base_time;        // Modification time of that text file
+} StudentJournalHeader;
+
+typedef struct {
+    unsigned int op;            // StudentJournalOp
+    int student_id;             // Target of an update or remove
+    unsigned int checksum;      // Adler-32 of the record with this field zeroed
+    unsigned int reserved;
+    Student student;            // New record for an add or update
+} StudentJournalRecord;
+
+// Background writer behind student_list_start_auto_save
+typedef struct StudentAutoSaver StudentAutoSaver;
+
 // Student list structure
 typedef struct {
-    Student* students;
-    int count;
-    int capacity;
-    int is_loaded; s          // Flag to track if data is loaded in memory
+    SegmentArray students;   // Student records; growth never moves existing ones
+    int count;               // Slots in use, tombstones included
+    FreeSlots free_slots;    // Tombstoned slots below count, reused by student_list_add
+    int is_loaded;           // Flag to track if data is loaded in memory
     char filename[256];      // Source filename for encrypted storage
     int auto_save_enabled;   // Flag for automatic saving
     time_t last_save_time;   // Timestamp of last save
+    HashIndex id_index;      // Student id -> position in students
+    HashIndex email_index;   // Lower-cased, trimmed email -> position
+    HashIndex name_index;    // Lower-cased, trimmed last+first name -> position
+    StudentJournalRecord* journal_pending;  // Mutations not yet appended to the journal
+    int journal_pending_count;
+    int journal_pending_capacity;
+    int journal_records;     // Records already in the journal file
+    int journal_needs_compaction;  // Journal cannot be appended to; next save rewrites the file
+    long long journal_base_size;   // Text file the journal applies to, as size
+    time_t journal_base_time;      // and modification time
+    unsigned long dirty_generation;  // Bumped on every change to the records
+    unsigned long saved_generation;  // dirty_generation as of the last completed save
+    StudentAutoSaver* auto_saver;    // NULL unless background saving was started
 } StudentList;
 
+// Binary snapshot of a StudentList: a StudentSnapshotHeader followed by
+// count raw Student records. Bump the version whenever Student changes.
+#define STUDENT_SNAPSHOT_MAGIC "STUSNAP"
+#define STUDENT_SNAPSHOT_VERSION 1
+#define STUDENT_SNAPSHOT_SUFFIX ".snap"
+
+typedef struct {
+    char magic[8];              // STUDENT_SNAPSHOT_MAGIC, NUL-padded
+    unsigned int byte_order;    // 0x01020304 as written by the saving machine
+    unsigned int version;       // STUDENT_SNAPSHOT_VERSION
+    unsigned int record_size;   // sizeof(Student) on the saving machine
+    unsigned int count;         // Number of records that follow
+    unsigned int checksum;      // Adler-32 of the records
+    unsigned int reserved;
+} StudentSnapshotHeader;
+
+// Sort keys for student_list_sorted_view
+typedef enum {
+    STUDENT_SORT_BY_NAME = 0,   // Last name, then first name
+    STUDENT_SORT_BY_ID = 1,     // Ascending id
+    STUDENT_SORT_BY_GPA = 2     // Descending GPA
+} StudentSortKey;
+
 // Function declarations
 StudentList* student_list_create(void);
 void student_list_destroy(StudentList* list);
 int student_list_add(StudentList* list, Student student);
+int student_list_add_many(StudentList* list, const Student* students, int count);
 int student_list_remove(StudentList* list, int student_id);
+void student_list_compact(StudentList* list);
 Student* student_list_find_by_id(StudentList* list, int student_id);
 Student* student_list_find_by_name(StudentList* list, const char* first_name, const char* last_name);
 Student* student_list_find_by_email(StudentList* list, const char* email);
+int student_list_update(StudentList* list, int student_id, Student updated);
+int student_list_edit(StudentList* list, int student_id);
 void student_list_display_all(StudentList* list);
 void student_list_display_student(Student* student);
 int student_list_save_to_file(StudentList* list, const char* filename);
 int student_list_load_from_file(StudentList* list, const char* filename);
+int student_list_save_snapshot(StudentList* list, const char* filename);
+int student_list_load_snapshot(StudentList* list, const char* filename);
 void student_list_sort_by_name(StudentList* list);
 void student_list_sort_by_id(StudentList* list);
 void student_list_sort_by_gpa(StudentList* list);
+int student_list_sorted_view(StudentList* list, StudentSortKey key, int* order);
 int student_list_get_count(StudentList* list);
 Student* student_list_get_student(StudentList* list, int index);
 
@@ -56,6 +136,10 @@ Student* student_list_get_student(StudentList* list, int index);
 int student_list_ensure_loaded(StudentList* list);
 int student_list_save_and_unload(StudentList* list);
 int student_list_auto_save(StudentList* list);
+int student_list_start_auto_save(StudentList* list, unsigned int interval_seconds);
+void student_list_stop_auto_save(StudentList* list);
+int student_list_auto_save_async(StudentList* list);
+int student_list_is_dirty(StudentList* list);
 int student_list_is_loaded(StudentList* list);
 void student_list_set_filename(StudentList* list, const char* filename);
 
@@ -19,6 +19,25 @@ typedef enum {
     UTILS_ERROR_OUT_OF_RANGE = -5
 } UtilsResult;
 
+// Read-only view of a whole file, memory-mapped where the platform allows
+typedef struct {
+    const char* data;
+    size_t size;
+    int is_mapped;   // 1 if data is a mapping, 0 if it was read into a heap buffer
+} UtilsMappedFile;
+
+// Local calendar fields of a time_t, as localtime() would report them
+typedef struct {
+    int year;
+    int month;         // 1-12
+    int day;           // 1-31
+    int hour;
+    int minute;
+    int second;
+    int day_of_week;   // 0 = Sunday
+    int day_of_year;   // 1-366
+} UtilsCivilDate;
+
 // String utilities
 char* utils_string_trim(char* str);
 char* utils_string_trim_left(char* str);
@@ -63,6 +82,8 @@ float utils_number_random_float(float min, float max);
 // Date and time utilities
 time_t utils_date_create(int year, int month, int day);
 time_t utils_date_create_with_time(int year, int month, int day, int hour, int minute, int second);
+int utils_date_civil(time_t date, UtilsCivilDate* civil);
+int utils_date_day_key(time_t date);
 int utils_date_get_year(time_t date);
 int utils_date_get_month(time_t date);
 int utils_date_get_day(time_t date);
@@ -101,6 +122,8 @@ int utils_file_get_directory(const char* path, char* directory, size_t size);
 char* utils_file_read_all(const char* filename);
 int utils_file_write_all(const char* filename, const char* content);
 int utils_file_append(const char* filename, const char* content);
+int utils_file_map(const char* filename, UtilsMappedFile* mapped);
+void utils_file_unmap(UtilsMappedFile* mapped);
 
 // Memory utilities
 void* utils_memory_allocate(size_t size);
@@ -169,6 +192,7 @@ unsigned long utils_hash_string(const char* str);
 unsigned long utils_hash_int(int value);
 unsigned long utils_hash_float(float value);
 unsigned long utils_hash_combine(unsigned long hash1, unsigned long hash2);
+unsigned int utils_hash_adler32(unsigned int adler, const void* data, size_t size);
 
 // Random utilities
 void utils_random_seed(unsigned int seed);
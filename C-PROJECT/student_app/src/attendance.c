@@ -2,8 +2,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <stdint.h>
+#include <limits.h>
 #include "attendance.h"
 #include "config.h"
+#include "utils.h"
 #include "crypto.h"
 #include "ui.h"
 #include "file_manager.h"
@@ -11,19 +14,318 @@
 #include "auth.h"
 #include "club.h"
 
+// Local calendar day of t as yyyymmdd, the granularity of the date lookups
+int attendance_day(time_t t) {
+    return utils_date_day_key(t);
+}
+
+static unsigned long attendance_key(int id, int day) {
+    return utils_hash_combine(utils_hash_int(id), utils_hash_int(day));
+}
+
+static void attendance_tally_table_init(AttendanceTallyTable* table) {
+    memset(table, 0, sizeof(*table));
+    hash_index_init(&table->index);
+}
+
+static void attendance_tally_table_free(AttendanceTallyTable* table) {
+    free(table->ids);
+    free(table->marked);
+    free(table->attended);
+    hash_index_free(&table->index);
+    attendance_tally_table_init(table);
+}
+
+// Entry of id, or -1
+static int attendance_tally_table_find(const AttendanceTallyTable* table, int id) {
+    HashIndexProbe probe;
+    int entry;
+    hash_index_probe_begin(&table->index, utils_hash_int(id), &probe);
+    while ((entry = hash_index_probe_next(&probe)) >= 0) {
+        if (table->ids[entry] == id)
+            return entry;
+    }
+    return -1;
+}
+
+// Entry of id, added with zero counts if new; -1 when out of memory
+static int attendance_tally_table_entry(AttendanceTallyTable* table, int id) {
+    int entry = attendance_tally_table_find(table, id);
+    if (entry >= 0)
+        return entry;
+    if (table->count >= table->capacity) {
+        int capacity = table->capacity > 0 ? table->capacity * 2 : 64;
+        int* ids = (int*)realloc(table->ids, sizeof(int) * (size_t)capacity);
+        if (!ids)
+            return -1;
+        table->ids = ids;
+        int* marked = (int*)realloc(table->marked, sizeof(int) * (size_t)capacity);
+        if (!marked)
+            return -1;
+        table->marked = marked;
+        int* attended = (int*)realloc(table->attended, sizeof(int) * (size_t)capacity);
+        if (!attended)
+            return -1;
+        table->attended = attended;
+        table->capacity = capacity;
+    }
+    entry = table->count;
+    if (!hash_index_insert(&table->index, utils_hash_int(id), entry))
+        return -1;
+    table->ids[entry] = id;
+    table->marked[entry] = 0;
+    table->attended[entry] = 0;
+    table->count++;
+    return entry;
+}
+
+static float attendance_tally_table_rate(const AttendanceTallyTable* table, int id) {
+    int entry = attendance_tally_table_find(table, id);
+    if (entry < 0 || table->marked[entry] == 0)
+        return -1;
+    return (float)table->attended[entry] / table->marked[entry] * 100.0f;
+}
+
+static void attendance_tally_init(AttendanceTally* tally) {
+    memset(tally, 0, sizeof(*tally));
+    attendance_tally_table_init(&tally->students);
+    attendance_tally_table_init(&tally->courses);
+}
+
+static void attendance_tally_free(AttendanceTally* tally) {
+    attendance_tally_table_free(&tally->students);
+    attendance_tally_table_free(&tally->courses);
+    attendance_tally_init(tally);
+}
+
+static int attendance_attends(int status) {
+    return status == ATTENDANCE_PRESENT || status == ATTENDANCE_LATE;
+}
+
+static int attendance_is_perfect(int marked, int attended) {
+    return marked > 0 && attended == marked;
+}
+
+static int attendance_is_poor(int marked, int attended) {
+    return marked > 0 && (float)attended / marked * 100.0f < POOR_ATTENDANCE_RATE;
+}
+
+// Count record into the totals (sign 1) or take it back out (sign -1)
+static void attendance_tally_apply(AttendanceTally* tally, const AttendanceRecord* record, int sign) {
+    if (tally->stale)
+        return;
+    int attends = attendance_attends(record->status) ? sign : 0;
+    tally->total += sign;
+    if (record->status >= ATTENDANCE_ABSENT && record->status <= ATTENDANCE_EXCUSED)
+        tally->by_status[record->status] += sign;
+    int month = utils_date_get_month(record->date) - 1;
+    if (month >= 0 && month < 12) {
+        tally->month_marked[month] += sign;
+        tally->month_attended[month] += attends;
+    }
+}
+
+// Move a student's standing in one session of the course from before to
+// after (ATTENDANCE_BITMAP_* flags); 0 when a table cannot grow
+static int attendance_tally_session(AttendanceTally* tally, int student_id, int course_id, int before, int after) {
+    if (before == after)
+        return 1;
+    AttendanceTallyTable* students = &tally->students;
+    int student = attendance_tally_table_entry(students, student_id);
+    int course = attendance_tally_table_entry(&tally->courses, course_id);
+    if (student < 0 || course < 0)
+        return 0;
+    int marked = ((after & ATTENDANCE_BITMAP_MARKED) != 0) - ((before & ATTENDANCE_BITMAP_MARKED) != 0);
+    int attended = ((after & ATTENDANCE_BITMAP_ATTENDED) != 0) - ((before & ATTENDANCE_BITMAP_ATTENDED) != 0);
+    tally->perfect_students -= attendance_is_perfect(students->marked[student], students->attended[student]);
+    tally->poor_students -= attendance_is_poor(students->marked[student], students->attended[student]);
+    students->marked[student] += marked;
+    students->attended[student] += attended;
+    tally->perfect_students += attendance_is_perfect(students->marked[student], students->attended[student]);
+    tally->poor_students += attendance_is_poor(students->marked[student], students->attended[student]);
+    tally->courses.marked[course] += marked;
+    tally->courses.attended[course] += attended;
+    return 1;
+}
+
+// The tally's tables follow the bitmap, so when either misses a write
+// both are recounted
+static void attendance_list_mark_stale(AttendanceList* list) {
+    list->tally.stale = 1;
+    list->bitmap.stale = 1;
+}
+
+// Record the live record in the course bitmaps and carry the change in the
+// student's standing over to the tally
+static void attendance_list_bitmap_add(AttendanceList* list, const AttendanceRecord* r) {
+    if (list->bitmap.stale)
+        return;
+    int flags = ATTENDANCE_BITMAP_MARKED | (attendance_attends(r->status) ? ATTENDANCE_BITMAP_ATTENDED : 0);
+    int before = attendance_bitmap_add(&list->bitmap, r->course_id, attendance_day(r->date), r->student_id, flags);
+    if (before < 0 || !attendance_tally_session(&list->tally, r->student_id, r->course_id, before, before | flags))
+        attendance_list_mark_stale(list);
+}
+
+// Standing of the student in the course session, from the live records
+// still indexed; a student may hold more than one record for a session
+static int attendance_list_session_flags(const AttendanceList* list, int course_id, int day, int student_id) {
+    int flags = 0;
+    HashIndexProbe probe;
+    int slot;
+    hash_index_probe_begin(&list->course_day_index, attendance_key(course_id, day), &probe);
+    while ((slot = hash_index_probe_next(&probe)) >= 0) {
+        const AttendanceRecord* r = &list->records[slot];
+        if (slot < list->count && r->id != TOMBSTONE_ID && r->student_id == student_id &&
+            r->course_id == course_id && attendance_day(r->date) == day) {
+            flags |= ATTENDANCE_BITMAP_MARKED;
+            if (attendance_attends(r->status))
+                flags |= ATTENDANCE_BITMAP_ATTENDED;
+        }
+    }
+    return flags;
+}
+
+// Bring the student's bits back in line after a record of the session was
+// removed or changed
+static void attendance_list_bitmap_refresh(AttendanceList* list, int course_id, int day, int student_id) {
+    if (list->bitmap.stale)
+        return;
+    int flags = attendance_list_session_flags(list, course_id, day, student_id);
+    int before = attendance_bitmap_set(&list->bitmap, course_id, day, student_id, flags);
+    if (before < 0 || !attendance_tally_session(&list->tally, student_id, course_id, before, flags))
+        attendance_list_mark_stale(list);
+}
+
+// Recount the totals and rebuild the bitmaps from scratch, after a load or
+// a failed update
+static void attendance_list_retally(AttendanceList* list) {
+    attendance_tally_free(&list->tally);
+    attendance_bitmap_free(&list->bitmap);
+    for (int i = 0; i < list->count && !list->tally.stale; i++) {
+        if (list->records[i].id != TOMBSTONE_ID) {
+            attendance_tally_apply(&list->tally, &list->records[i], 1);
+            attendance_list_bitmap_add(list, &list->records[i]);
+        }
+    }
+}
+
+// Bitmaps brought up to date, or NULL when there is not enough memory
+static const AttendanceBitmap* attendance_list_bitmap(AttendanceList* list) {
+    if (list == NULL)
+        return NULL;
+    if (list->tally.stale || list->bitmap.stale)
+        attendance_list_retally(list);
+    return list->bitmap.stale ? NULL : &list->bitmap;
+}
+
+// Add the record at position slot to the id and date indexes
+static int attendance_list_index_record(AttendanceList* list, int slot) {
+    AttendanceRecord* r = &list->records[slot];
+    return hash_index_insert(&list->id_index, utils_hash_int(r->id), slot) &&
+           hash_index_insert(&list->student_day_index, attendance_key(r->student_id, attendance_day(r->recorded_time)), slot) &&
+           hash_index_insert(&list->course_day_index, attendance_key(r->course_id, attendance_day(r->date)), slot);
+}
+
+static void attendance_list_unindex_record(AttendanceList* list, int slot) {
+    AttendanceRecord* r = &list->records[slot];
+    hash_index_remove(&list->id_index, utils_hash_int(r->id), slot);
+    hash_index_remove(&list->student_day_index, attendance_key(r->student_id, attendance_day(r->recorded_time)), slot);
+    hash_index_remove(&list->course_day_index, attendance_key(r->course_id, attendance_day(r->date)), slot);
+}
+
+// Rebuild the indexes after records have been moved or reloaded
+static int attendance_list_rebuild_indexes(AttendanceList* list) {
+    hash_index_clear(&list->id_index);
+    hash_index_clear(&list->student_day_index);
+    hash_index_clear(&list->course_day_index);
+    if (!hash_index_reserve(&list->id_index, list->count) ||
+        !hash_index_reserve(&list->student_day_index, list->count) ||
+        !hash_index_reserve(&list->course_day_index, list->count))
+        return 0;
+    for (int i = 0; i < list->count; i++) {
+        if (list->records[i].id != TOMBSTONE_ID && !attendance_list_index_record(list, i))
+            return 0;
+    }
+    return 1;
+}
+
+// Count a record that has just joined the list into the totals and bitmaps
+static void attendance_list_count_record(AttendanceList* list, const AttendanceRecord* r) {
+    attendance_tally_apply(&list->tally, r, 1);
+    attendance_list_bitmap_add(list, r);
+}
+
+// Insert the record just written at slot into the indexes. slot is either a
+// tombstoned slot being reused or list->count, which only joins the list
+// once indexed. On failure a reused slot is tombstoned again, so the list
+// and its indexes stay in step either way.
+static int attendance_list_commit_slot(AttendanceList* list, int slot) {
+    if (attendance_list_index_record(list, slot)) {
+        if (slot == list->count)
+            list->count++;
+        attendance_list_count_record(list, &list->records[slot]);
+        return 1;
+    }
+    printf("erreur d'indexation de l'enregistrement %d ", list->records[slot].id);
+    attendance_list_unindex_record(list, slot);
+    if (slot < list->count) {
+        list->records[slot].id = TOMBSTONE_ID;
+        free_slots_push(&list->free_slots, slot);
+    }
+    return 0;
+}
+
+// Index the count records written from slot first, just past list->count.
+// If an insert fails, every entry already added for the block is taken back
+// out and 0 is returned with the indexes as they were.
+static int attendance_list_index_block(AttendanceList* list, int first, int count) {
+    for (int i = 0; i < count; i++) {
+        if (!attendance_list_index_record(list, first + i)) {
+            for (int j = 0; j <= i; j++)
+                attendance_list_unindex_record(list, first + j);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Position of the earliest record with this id, or -1
+static int attendance_list_slot_of_id(const AttendanceList* list, int record_id) {
+    int found = -1;
+    HashIndexProbe probe;
+    int slot;
+    hash_index_probe_begin(&list->id_index, utils_hash_int(record_id), &probe);
+    while ((slot = hash_index_probe_next(&probe)) >= 0) {
+        if (slot < list->count && (found < 0 || slot < found) &&
+            list->records[slot].id == record_id) {
+            found = slot;
+        }
+    }
+    return found;
+}
 
+static int attendance_compare_slots(const void* a, const void* b) {
+    return *(const int*)a - *(const int*)b;
+}
 
 AttendanceList* attendance_list_create() {
     AttendanceList* list = (AttendanceList*)malloc(sizeof(AttendanceList));
     if (!list) return NULL;
 
     list->count = 0;
-    list->capacity = 40;
+    list->capacity = ATTENDANCE_LIST_MIN_CAPACITY;
     list->records = (AttendanceRecord*)malloc(sizeof(AttendanceRecord) * list->capacity);
     if (!list->records) {
         free(list);
         return NULL;
     }
+    free_slots_init(&list->free_slots);
+    list->next_id = 1;
+    hash_index_init(&list->id_index);
+    hash_index_init(&list->student_day_index);
+    hash_index_init(&list->course_day_index);
+    attendance_tally_init(&list->tally);
+    attendance_bitmap_init(&list->bitmap);
     return list;
 }
 
@@ -36,17 +338,41 @@ void attendance_list_destroy(AttendanceList* list) {
     }
     list->count = 0;
     list->capacity = 0;
+    free_slots_free(&list->free_slots);
+    hash_index_free(&list->id_index);
+    hash_index_free(&list->student_day_index);
+    hash_index_free(&list->course_day_index);
+    attendance_tally_free(&list->tally);
+    attendance_bitmap_free(&list->bitmap);
     free(list);
 }
 
+// Tombstoned slot to reuse, or -1
+static int attendance_list_take_free_slot(AttendanceList* list) {
+    int slot = free_slots_pop(&list->free_slots);
+    while (slot >= 0 && (slot >= list->count || list->records[slot].id != TOMBSTONE_ID)) {
+        slot = free_slots_pop(&list->free_slots);
+    }
+    return slot;
+}
+
 int attendance_list_add(AttendanceList *list, AttendanceRecord record) {
     if (list == NULL)
         return 0;
 
-    if (list->count >= list->capacity)
+    int slot = attendance_list_take_free_slot(list);
+    if (slot < 0) {
+        if (list->count >= list->capacity)
+            return 0;
+        slot = list->count;
+    }
+    list->records[slot] = record;
+    if (!attendance_list_commit_slot(list, slot))
         return 0;
 
-    list->records[list->count++] = record;
+    // Keep the sequence ahead of ids chosen by the caller
+    if (record.id >= list->next_id)
+        list->next_id = record.id + 1;
     return 1;
 }
 
@@ -54,63 +380,88 @@ int attendance_list_remove(AttendanceList* list, int record_id) {
     if (list == NULL || list->count == 0)
         return 0;
 
+    int i = attendance_list_slot_of_id(list, record_id);
+    if (i < 0)
+        return 0;
+    // Tombstone instead of shifting the records behind it
+    AttendanceRecord removed = list->records[i];
+    attendance_list_unindex_record(list, i);
+    attendance_tally_apply(&list->tally, &removed, -1);
+    memset(&list->records[i], 0, sizeof(AttendanceRecord));
+    list->records[i].id = TOMBSTONE_ID;
+    attendance_list_bitmap_refresh(list, removed.course_id, attendance_day(removed.date), removed.student_id);
+    if (!free_slots_push(&list->free_slots, i) ||
+        free_slots_should_compact(&list->free_slots, list->count)) {
+        attendance_list_compact(list);
+    }
+    return 1;
+}
+
+// Squeeze out tombstones, keeping the remaining records in order
+void attendance_list_compact(AttendanceList* list) {
+    if (list == NULL || list->records == NULL)
+        return;
+
+    int live = 0;
     for (int i = 0; i < list->count; i++) {
-        if (list->records[i].id == record_id) {
-            for (int j = i; j < list->count - 1; j++) {
-                list->records[j] = list->records[j + 1];
-            }
-            list->count--;
-            return 1;
-        }
+        if (list->records[i].id == TOMBSTONE_ID)
+            continue;
+        if (i != live)
+            list->records[live] = list->records[i];
+        live++;
     }
-    return 0;
+    int moved = live != list->count;
+    list->count = live;
+    free_slots_clear(&list->free_slots);
+    if (moved && !attendance_list_rebuild_indexes(list))
+        printf("erreur de reconstruction des index ");
 }
 
 AttendanceRecord* attendance_list_find_by_id(AttendanceList* list, int record_id) {
     if (list == NULL)
         return NULL;
-    for (int i = 0; i < list->count; i++) {
-        if (list->records[i].id == record_id) {
-            return &(list->records[i]);
-        }
-    }
-    return NULL;
+    int slot = attendance_list_slot_of_id(list, record_id);
+    return slot >= 0 ? &(list->records[slot]) : NULL;
 }
 
+// Earliest record the student has marked on the day of date
 AttendanceRecord* attendance_list_find_by_student_date(AttendanceList* list, int student_id, time_t date) {
     if (list == NULL)
         return NULL;
-    for (int i = 0; i < list->count; i++) {
-        if (list->records[i].student_id == student_id) {
-            struct tm tm1 = *localtime(&date);
-            struct tm tm2 = *localtime(&(list->records[i].recorded_time));
-
-            if (tm1.tm_year == tm2.tm_year &&
-                tm1.tm_mon == tm2.tm_mon &&
-                tm1.tm_mday == tm2.tm_mday) {
-                return &(list->records[i]);
-            }
+    int day = attendance_day(date);
+    int found = -1;
+    HashIndexProbe probe;
+    int slot;
+    hash_index_probe_begin(&list->student_day_index, attendance_key(student_id, day), &probe);
+    while ((slot = hash_index_probe_next(&probe)) >= 0) {
+        if (slot < list->count && (found < 0 || slot < found) &&
+            list->records[slot].id != TOMBSTONE_ID &&
+            list->records[slot].student_id == student_id &&
+            attendance_day(list->records[slot].recorded_time) == day) {
+            found = slot;
         }
     }
-    return NULL;
+    return found >= 0 ? &(list->records[found]) : NULL;
 }
 
+// Earliest record for the course held on the day of date
 AttendanceRecord* attendance_list_find_by_course_date(AttendanceList* list, int course_id, time_t date) {
     if (list == NULL)
         return NULL;
-    for (int i = 0; i < list->count; i++) {
-        if (list->records[i].course_id == course_id) {
-            struct tm tm1 = *localtime(&date);
-            struct tm tm2 = *localtime(&(list->records[i].date));
-
-            if (tm1.tm_year == tm2.tm_year &&
-                tm1.tm_mon == tm2.tm_mon &&
-                tm1.tm_mday == tm2.tm_mday) {
-                return &(list->records[i]);
-            }
+    int day = attendance_day(date);
+    int found = -1;
+    HashIndexProbe probe;
+    int slot;
+    hash_index_probe_begin(&list->course_day_index, attendance_key(course_id, day), &probe);
+    while ((slot = hash_index_probe_next(&probe)) >= 0) {
+        if (slot < list->count && (found < 0 || slot < found) &&
+            list->records[slot].id != TOMBSTONE_ID &&
+            list->records[slot].course_id == course_id &&
+            attendance_day(list->records[slot].date) == day) {
+            found = slot;
         }
     }
-    return NULL;
+    return found >= 0 ? &(list->records[found]) : NULL;
 }
 
 int mark_attendance(AttendanceList* list, int student_id, int course_id, time_t date, int status, int teacher_id){
@@ -119,8 +470,9 @@ int mark_attendance(AttendanceList* list, int student_id, int course_id, time_t
         return -1;
     }
     
-    // Check if we need to reallocate
-    if(list->count >= list->capacity){
+    // Reuse a tombstoned slot, or append (reallocating if needed)
+    int slot = attendance_list_take_free_slot(list);
+    if(slot < 0 && list->count >= list->capacity){
         int new_capacity = (list->capacity == 0) ? 10 : list->capacity * 2;
         AttendanceRecord* newblock = (AttendanceRecord *)realloc(list->records, new_capacity * sizeof(AttendanceRecord));
         if(!newblock){
@@ -133,15 +485,7 @@ int mark_attendance(AttendanceList* list, int student_id, int course_id, time_t
     
     AttendanceRecord newrecord;
     
-    // Find the next available ID
-    int max_id = 0;
-    for(int i = 0; i < list->count; i++){
-        if(list->records[i].id > max_id){
-            max_id = list->records[i].id;
-        }
-    }
-    
-    newrecord.id = max_id + 1;
+    newrecord.id = list->next_id;
     newrecord.student_id = student_id;
     newrecord.course_id = course_id;
     newrecord.date = date;
@@ -150,8 +494,144 @@ int mark_attendance(AttendanceList* list, int student_id, int course_id, time_t
     strcpy(newrecord.reason, ""); 
     newrecord.recorded_time = time(NULL); // temps exacte d'enregistrement 
 
-    list->records[list->count] = newrecord;
-    list->count++;
+    if(slot < 0){
+        slot = list->count;
+    }
+    list->records[slot] = newrecord;
+    if(!attendance_list_commit_slot(list, slot)){
+        return -1;
+    }
+    list->next_id++;
+
+    return 0;
+}
+// Make room for count records appended after the current ones, in both
+// the records array and the date indexes
+static int attendance_list_reserve_block(AttendanceList* list, int count){
+    if(list->count + count > list->capacity){
+        int new_capacity = (list->capacity == 0) ? 10 : list->capacity * 2;
+        if(new_capacity < list->count + count){
+            new_capacity = list->count + count;
+        }
+        AttendanceRecord* newblock = (AttendanceRecord *)realloc(list->records, new_capacity * sizeof(AttendanceRecord));
+        if(!newblock){
+            printf("erreur de reallocation ");
+            return 0;
+        }
+        list->records = newblock;
+        list->capacity = new_capacity;
+    }
+    if(!hash_index_reserve(&list->id_index, list->count + count) ||
+       !hash_index_reserve(&list->student_day_index, list->count + count) ||
+       !hash_index_reserve(&list->course_day_index, list->count + count)){
+        printf("erreur de reallocation ");
+        return 0;
+    }
+    return 1;
+}
+// Bulk version of mark_attendance: takes student, course, date, status,
+// teacher and reason from each entry of marks and appends them all with a
+// single reallocation. Ids are taken from the list's sequence.
+// All-or-nothing; 0 on success, -1 on error.
+int mark_attendance_many(AttendanceList* list, const AttendanceRecord* marks, int count){
+    if(list == NULL || count < 0 || (marks == NULL && count > 0)){
+        printf("erreur la list est nulle ");
+        return -1;
+    }
+    for(int i = 0; i < count; i++){
+        if(marks[i].status < ATTENDANCE_ABSENT || marks[i].status > ATTENDANCE_EXCUSED){
+            printf("erreur statut invalide a la position %d ", i);
+            return -1;
+        }
+    }
+    if(count == 0){
+        return 0;
+    }
+    if(!attendance_list_reserve_block(list, count)){
+        return -1;
+    }
+
+    time_t now = time(NULL);
+
+    AttendanceRecord* dest = &list->records[list->count];
+    memcpy(dest, marks, count * sizeof(AttendanceRecord));
+    for(int i = 0; i < count; i++){
+        dest[i].id = list->next_id + i;
+        dest[i].reason[sizeof(dest[i].reason) - 1] = '\0';
+        dest[i].recorded_time = now;
+    }
+    // Indexed past the end first: the list only takes the block once every
+    // record is in the indexes
+    if(!attendance_list_index_block(list, list->count, count)){
+        printf("erreur d'indexation du lot ");
+        return -1;
+    }
+    list->count += count;
+    list->next_id += count;
+    for(int i = 0; i < count; i++){
+        attendance_list_count_record(list, &dest[i]);
+    }
+
+    return 0;
+}
+// Mark a whole class session at once: every mark shares the course, date
+// and teacher, so the ids come from the sequence as one block, the records
+// are appended contiguously and both index keys are computed only once.
+// All-or-nothing; 0 on success, -1 on error.
+int mark_attendance_session(AttendanceList* list, int course_id, time_t date, int teacher_id, const AttendanceMark* marks, int count){
+    if(list == NULL || count < 0 || (marks == NULL && count > 0)){
+        printf("erreur la list est nulle ");
+        return -1;
+    }
+    for(int i = 0; i < count; i++){
+        if(marks[i].status < ATTENDANCE_ABSENT || marks[i].status > ATTENDANCE_EXCUSED){
+            printf("erreur statut invalide a la position %d ", i);
+            return -1;
+        }
+    }
+    if(count == 0){
+        return 0;
+    }
+    if(!attendance_list_reserve_block(list, count)){
+        return -1;
+    }
+
+    time_t now = time(NULL);
+    int recorded_day = attendance_day(now);
+    unsigned long course_key = attendance_key(course_id, attendance_day(date));
+    int first = list->count;
+    AttendanceRecord* dest = &list->records[first];
+    memset(dest, 0, count * sizeof(AttendanceRecord));
+    for(int i = 0; i < count; i++){
+        dest[i].id = list->next_id + i;
+        dest[i].student_id = marks[i].student_id;
+        dest[i].course_id = course_id;
+        dest[i].date = date;
+        dest[i].status = marks[i].status;
+        dest[i].teacher_id = teacher_id;
+        dest[i].recorded_time = now;
+    }
+    int indexed = 0;
+    while(indexed < count &&
+          hash_index_insert(&list->id_index, utils_hash_int(dest[indexed].id), first + indexed) &&
+          hash_index_insert(&list->student_day_index, attendance_key(marks[indexed].student_id, recorded_day), first + indexed) &&
+          hash_index_insert(&list->course_day_index, course_key, first + indexed)){
+        indexed++;
+    }
+    // An index ran out of memory: take the block back out of the indexes
+    // before anything else has seen it, leaving the list as it was
+    if(indexed < count){
+        for(int i = 0; i <= indexed; i++){
+            attendance_list_unindex_record(list, first + i);
+        }
+        printf("erreur d'indexation de la seance ");
+        return -1;
+    }
+    list->count += count;
+    list->next_id += count;
+    for(int i = 0; i < count; i++){
+        attendance_list_count_record(list, &dest[i]);
+    }
 
     return 0;
 }
@@ -161,19 +641,103 @@ int update_attendance(AttendanceList* list, int record_id, int new_status, const
         return -1;
     }
     
-    for(int i = 0 ; i < list->count ; i++){
-        if(list->records[i].id == record_id){
-            list->records[i].status = new_status ;
-            if(reason != NULL){
-            strncpy(list->records[i].reason , reason , 199);
-            list->records[i].reason[199] = '\0';
-            }
-            return 0;
+    // Status and reason are not index keys, so the indexes are untouched;
+    // the totals move the record from its old status to the new one
+    int i = attendance_list_slot_of_id(list, record_id);
+    if(i >= 0){
+        attendance_tally_apply(&list->tally, &list->records[i], -1);
+        list->records[i].status = new_status ;
+        attendance_tally_apply(&list->tally, &list->records[i], 1);
+        attendance_list_bitmap_refresh(list, list->records[i].course_id,
+                                       attendance_day(list->records[i].date), list->records[i].student_id);
+        if(reason != NULL){
+        strncpy(list->records[i].reason , reason , 199);
+        list->records[i].reason[199] = '\0';
         }
+        return 0;
     }
    return -1 ; //record non trouver 
 }
 
+// Totals kept up to date by every write; recounted only if an earlier
+// update ran out of memory, and NULL if the recount does too
+const AttendanceTally* attendance_list_tally(AttendanceList* list) {
+    if (list == NULL)
+        return NULL;
+    if (list->tally.stale || list->bitmap.stale)
+        attendance_list_retally(list);
+    return list->tally.stale ? NULL : &list->tally;
+}
+
+// Percent of the student's sessions attended (present or late), or -1
+float attendance_student_rate(AttendanceList* list, int student_id) {
+    const AttendanceTally* tally = attendance_list_tally(list);
+    return tally ? attendance_tally_table_rate(&tally->students, student_id) : -1;
+}
+
+// Percent of the course's (session, student) marks that were attended, or -1
+float attendance_course_rate(AttendanceList* list, int course_id) {
+    const AttendanceTally* tally = attendance_list_tally(list);
+    return tally ? attendance_tally_table_rate(&tally->courses, course_id) : -1;
+}
+
+// Fill student_ids with up to max_count students present or late at the
+// course's session on the day of date; returns how many there were, or -1
+int attendance_roll_call(AttendanceList* list, int course_id, time_t date, int* student_ids, int max_count) {
+    const AttendanceBitmap* bitmap = attendance_list_bitmap(list);
+    if (bitmap == NULL)
+        return -1;
+    return attendance_bitmap_attended_students(bitmap, course_id, attendance_day(date), student_ids, max_count);
+}
+
+// Percent of the students marked at the session who attended, or -1
+float attendance_session_rate(AttendanceList* list, int course_id, time_t date) {
+    const AttendanceBitmap* bitmap = attendance_list_bitmap(list);
+    int marked, attended;
+    if (bitmap == NULL ||
+        !attendance_bitmap_session_counts(bitmap, course_id, attendance_day(date), &marked, &attended) ||
+        marked == 0)
+        return -1;
+    return (float)attended / marked * 100.0f;
+}
+
+// Percent of the course's sessions the student was marked for and attended, or -1
+float attendance_student_course_rate(AttendanceList* list, int student_id, int course_id) {
+    const AttendanceBitmap* bitmap = attendance_list_bitmap(list);
+    int marked, attended;
+    if (bitmap == NULL ||
+        !attendance_bitmap_student_sessions(bitmap, course_id, student_id, &marked, &attended) ||
+        marked == 0)
+        return -1;
+    return (float)attended / marked * 100.0f;
+}
+
+void attendance_date_iter_begin(AttendanceList* list, int course_id, time_t date, AttendanceDateIterator* iter) {
+    if (iter == NULL)
+        return;
+    iter->list = list;
+    iter->course_id = course_id;
+    iter->date = date;
+    hash_index_probe_begin(list ? &list->course_day_index : NULL,
+                           attendance_key(course_id, attendance_day(date)), &iter->probe);
+}
+
+// Next record of the session, or NULL once there are no more
+AttendanceRecord* attendance_date_iter_next(AttendanceDateIterator* iter) {
+    if (iter == NULL || iter->list == NULL)
+        return NULL;
+    AttendanceList* list = iter->list;
+    int slot;
+    while ((slot = hash_index_probe_next(&iter->probe)) >= 0) {
+        if (slot >= list->count)
+            continue;
+        AttendanceRecord* r = &list->records[slot];
+        if (r->id != TOMBSTONE_ID && r->course_id == iter->course_id && r->date == iter->date)
+            return r;
+    }
+    return NULL;
+}
+
 int get_attendance_for_date(AttendanceList* list,int course_id,time_t date,AttendanceRecord** records,int* count){
 
     if (list == NULL || records == NULL || count == NULL) {
@@ -184,11 +748,25 @@ int get_attendance_for_date(AttendanceList* list,int course_id,time_t date,Atten
     *records = NULL; 
     
 
-   
-    for (int i = 0; i < list->count; i++) {
-        if (list->records[i].course_id == course_id && list->records[i].date == date){
-            (*count)++;
+    // Callers that can work on references should use attendance_date_iter_*
+    // instead; this copy exists for callers that keep the result around
+    AttendanceDateIterator iter;
+    AttendanceRecord* match;
+    int capacity = 0;
+    int* slots = NULL;
+    attendance_date_iter_begin(list, course_id, date, &iter);
+    while ((match = attendance_date_iter_next(&iter)) != NULL) {
+        if (*count >= capacity) {
+            capacity = capacity > 0 ? capacity * 2 : 16;
+            int* grown = realloc(slots, sizeof(int) * capacity);
+            if (grown == NULL) {
+                free(slots);
+                *count = 0;
+                return -1;
+            }
+            slots = grown;
         }
+        slots[(*count)++] = (int)(match - list->records);
     }
 
 
@@ -199,18 +777,17 @@ int get_attendance_for_date(AttendanceList* list,int course_id,time_t date,Atten
   
     *records = malloc(sizeof(AttendanceRecord) * (*count));
     if (*records == NULL) {
+        free(slots);
+        *count = 0;
         return -1; 
     }
 
-    int index = 0;
-    for (int i = 0; i < list->count; i++) {
-        if (list->records[i].course_id == course_id &&
-            list->records[i].date == date)
-        {
-            (*records)[index] = list->records[i];
-            index++;
-        }
+    // Same order as the records are stored in
+    qsort(slots, *count, sizeof(int), attendance_compare_slots);
+    for (int i = 0; i < *count; i++) {
+        (*records)[i] = list->records[slots[i]];
     }
+    free(slots);
 
     return 0; 
 }
@@ -221,16 +798,20 @@ void attendance_list_display_all(AttendanceList* list) {
         return;
     }
     
-    if (list->count == 0) {
+    int live = list->count - list->free_slots.count;
+    if (live == 0) {
         printf("Attendance list is empty\n");
         return;
     }
     
     printf("\n=== ALL ATTENDANCE RECORDS ===\n");
-    printf("Total records: %d\n\n", list->count);
+    printf("Total records: %d\n\n", live);
     
+    int shown = 0;
     for (int i = 0; i < list->count; i++) {
-        printf("Record %d:\n", i + 1);
+        if (list->records[i].id == TOMBSTONE_ID)
+            continue;
+        printf("Record %d:\n", ++shown);
         attendance_display_record(&(list->records[i]));
         printf("--------------------\n");
     }
@@ -244,11 +825,16 @@ void attendance_display_record(AttendanceRecord* record) {
     
     char date_str[64];
     char recorded_time_str[64];
-    struct tm* date_tm = localtime(&(record->date));
-    struct tm* recorded_tm = localtime(&(record->recorded_time));
+    UtilsCivilDate date_civil = {0};
+    UtilsCivilDate recorded_civil = {0};
+    utils_date_civil(record->date, &date_civil);
+    utils_date_civil(record->recorded_time, &recorded_civil);
     
-    strftime(date_str, sizeof(date_str), "%Y-%m-%d", date_tm);
-    strftime(recorded_time_str, sizeof(recorded_time_str), "%Y-%m-%d %H:%M:%S", recorded_tm);
+    snprintf(date_str, sizeof(date_str), "%04d-%02d-%02d",
+             date_civil.year, date_civil.month, date_civil.day);
+    snprintf(recorded_time_str, sizeof(recorded_time_str), "%04d-%02d-%02d %02d:%02d:%02d",
+             recorded_civil.year, recorded_civil.month, recorded_civil.day,
+             recorded_civil.hour, recorded_civil.minute, recorded_civil.second);
     
     const char* status_str;
     switch (record->status) {
@@ -281,6 +867,65 @@ void attendance_display_record(AttendanceRecord* record) {
     }
 }
 
+// Little-endian field access for the attendance file
+static void attendance_put_u32(unsigned char* p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+static uint32_t attendance_get_u32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void attendance_put_u64(unsigned char* p, uint64_t v) {
+    attendance_put_u32(p, (uint32_t)v);
+    attendance_put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint64_t attendance_get_u64(const unsigned char* p) {
+    return (uint64_t)attendance_get_u32(p) | ((uint64_t)attendance_get_u32(p + 4) << 32);
+}
+
+static void attendance_encode_record(unsigned char* p, const AttendanceRecord* r) {
+    memset(p, 0, ATTENDANCE_FILE_RECORD_SIZE);
+    attendance_put_u32(p + 0, (uint32_t)r->id);
+    attendance_put_u32(p + 4, (uint32_t)r->student_id);
+    attendance_put_u32(p + 8, (uint32_t)r->course_id);
+    attendance_put_u32(p + 12, (uint32_t)r->status);
+    attendance_put_u32(p + 16, (uint32_t)r->teacher_id);
+    attendance_put_u64(p + 24, (uint64_t)(int64_t)r->date);
+    attendance_put_u64(p + 32, (uint64_t)(int64_t)r->recorded_time);
+    strncpy((char*)p + 40, r->reason, sizeof(r->reason) - 1);
+}
+
+static void attendance_decode_record(AttendanceRecord* r, const unsigned char* p) {
+    r->id = (int32_t)attendance_get_u32(p + 0);
+    r->student_id = (int32_t)attendance_get_u32(p + 4);
+    r->course_id = (int32_t)attendance_get_u32(p + 8);
+    r->status = (int32_t)attendance_get_u32(p + 12);
+    r->teacher_id = (int32_t)attendance_get_u32(p + 16);
+    r->date = (time_t)(int64_t)attendance_get_u64(p + 24);
+    r->recorded_time = (time_t)(int64_t)attendance_get_u64(p + 32);
+    memcpy(r->reason, p + 40, sizeof(r->reason));
+    r->reason[sizeof(r->reason) - 1] = '\0';
+}
+
+static void attendance_encode_header(unsigned char* p, int count, int next_id, uint32_t records_checksum) {
+    memset(p, 0, ATTENDANCE_FILE_HEADER_SIZE);
+    memcpy(p, ATTENDANCE_FILE_MAGIC, sizeof(ATTENDANCE_FILE_MAGIC));
+    attendance_put_u32(p + 8, ATTENDANCE_FILE_VERSION);
+    attendance_put_u32(p + 12, ATTENDANCE_FILE_RECORD_SIZE);
+    attendance_put_u32(p + 16, (uint32_t)count);
+    attendance_put_u32(p + 20, (uint32_t)next_id);
+    attendance_put_u32(p + 24, records_checksum);
+    attendance_put_u32(p + 28, utils_hash_adler32(1, p, 28));
+}
+
+// Records encoded or decoded per batch
+#define ATTENDANCE_FILE_CHUNK 256
+
 int attendance_list_save_to_file(AttendanceList* list, const char* filename) {
     if (!list || !filename)
         return -1;
@@ -289,62 +934,151 @@ int attendance_list_save_to_file(AttendanceList* list, const char* filename) {
     if (!fp)
         return -1;
 
-    // Save the count
-    if (fwrite(&(list->count), sizeof(int), 1, fp) != 1) {
-        fclose(fp);
+    // The header goes in last, once the records checksum is known
+    unsigned char header[ATTENDANCE_FILE_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    int ok = fwrite(header, sizeof(header), 1, fp) == 1;
+
+    unsigned char chunk[ATTENDANCE_FILE_CHUNK * ATTENDANCE_FILE_RECORD_SIZE];
+    uint32_t checksum = 1;
+    int written = 0;
+    for (int i = 0; ok && i < list->count; ) {
+        // The file never holds tombstones; they are skipped, not compacted away
+        int n = 0;
+        for (; i < list->count && n < ATTENDANCE_FILE_CHUNK; i++) {
+            if (list->records[i].id == TOMBSTONE_ID)
+                continue;
+            attendance_encode_record(chunk + (size_t)n * ATTENDANCE_FILE_RECORD_SIZE, &list->records[i]);
+            n++;
+        }
+        if (n == 0)
+            break;
+        written += n;
+        size_t size = (size_t)n * ATTENDANCE_FILE_RECORD_SIZE;
+        checksum = utils_hash_adler32(checksum, chunk, size);
+        ok = fwrite(chunk, 1, size, fp) == size;
+    }
+
+    if (ok) {
+        attendance_encode_header(header, written, list->next_id, checksum);
+        ok = fseek(fp, 0, SEEK_SET) == 0 && fwrite(header, sizeof(header), 1, fp) == 1;
+    }
+    if (fclose(fp) != 0)
+        ok = 0;
+    if (!ok) {
+        remove(filename);
         return -1;
     }
+    return 0;
+}
 
-    // Save the records
-    if (list->count > 0) {
-        if (fwrite(list->records, sizeof(AttendanceRecord), list->count, fp) != (size_t)list->count) {
-            fclose(fp);
-            return -1;
+// Install count records, leaving room to grow, and rebuild everything
+// derived from them
+static int attendance_list_adopt(AttendanceList* list, AttendanceRecord* records, int count, int capacity, int next_id) {
+    free(list->records);
+    list->records = records;
+    list->count = count;
+    list->capacity = capacity;
+    free_slots_clear(&list->free_slots);
+    if (next_id < 1) {
+        next_id = 1;
+        for (int i = 0; i < count; i++) {
+            if (records[i].id >= next_id)
+                next_id = records[i].id + 1;
         }
     }
+    list->next_id = next_id;
+    attendance_list_retally(list);
+    return attendance_list_rebuild_indexes(list) ? 0 : -1;
+}
 
-    fclose(fp);
-    return 0;
+static AttendanceRecord* attendance_list_alloc_loaded(int count, int* capacity) {
+    *capacity = count + count / 4 + ATTENDANCE_LIST_MIN_CAPACITY;
+    return (AttendanceRecord*)malloc(sizeof(AttendanceRecord) * (size_t)*capacity);
+}
+
+// Files written before the portable format: an int count, the raw record
+// array of the saving build, then optionally the id sequence
+static int attendance_list_load_legacy(AttendanceList* list, const UtilsMappedFile* mapped) {
+    int count = 0;
+    if (mapped->size < sizeof(int))
+        return -1;
+    memcpy(&count, mapped->data, sizeof(int));
+    size_t records_size = sizeof(AttendanceRecord) * (size_t)count;
+    if (count < 0 || mapped->size - sizeof(int) < records_size)
+        return -1;
+
+    int capacity;
+    AttendanceRecord* records = attendance_list_alloc_loaded(count, &capacity);
+    if (!records)
+        return -1;
+    memcpy(records, mapped->data + sizeof(int), records_size);
+
+    int next_id = 0;
+    if (mapped->size - sizeof(int) - records_size >= sizeof(int))
+        memcpy(&next_id, mapped->data + sizeof(int) + records_size, sizeof(int));
+    return attendance_list_adopt(list, records, count, capacity, next_id);
 }
 
 int attendance_list_load_from_file(AttendanceList* list, const char* filename){
     if (!list || !filename)
         return -1;
 
-    FILE* fp = fopen(filename, "rb");
-    if (!fp)
+    // Mapped rather than read: pages come in as the decode loop reaches them
+    UtilsMappedFile mapped;
+    if (!utils_file_map(filename, &mapped))
         return -1;
 
-    int count = 0;
-    // Read the count first
-    if (fread(&count, sizeof(int), 1, fp) != 1) {
-        fclose(fp);
-        return -1;
+    const unsigned char* data = (const unsigned char*)mapped.data;
+    if (mapped.size < ATTENDANCE_FILE_HEADER_SIZE ||
+        memcmp(data, ATTENDANCE_FILE_MAGIC, sizeof(ATTENDANCE_FILE_MAGIC)) != 0) {
+        int result = attendance_list_load_legacy(list, &mapped);
+        utils_file_unmap(&mapped);
+        return result;
     }
 
-    // Allocate if necessary
-    if (list->records) {
-        free(list->records);
-        list->records = NULL;
+    // The header is checked on its own, before any record page is touched
+    const char* problem = NULL;
+    uint32_t count = attendance_get_u32(data + 16);
+    if (attendance_get_u32(data + 28) != utils_hash_adler32(1, data, 28)) {
+        problem = "header checksum mismatch";
+    } else if (attendance_get_u32(data + 8) != ATTENDANCE_FILE_VERSION) {
+        problem = "unsupported version";
+    } else if (attendance_get_u32(data + 12) != ATTENDANCE_FILE_RECORD_SIZE) {
+        problem = "unexpected record size";
+    } else if (count > (uint32_t)(INT_MAX / 2) ||
+               mapped.size - ATTENDANCE_FILE_HEADER_SIZE != (size_t)count * ATTENDANCE_FILE_RECORD_SIZE) {
+        problem = "record count does not match file size";
     }
-    if (count > 0) {
-        list->records = (AttendanceRecord*)malloc(sizeof(AttendanceRecord) * count);
-        if (!list->records) {
-            fclose(fp);
-            return -1;
-        }
-        if (fread(list->records, sizeof(AttendanceRecord), count, fp) != (size_t)count) {
-            free(list->records);
-            list->records = NULL;
-            fclose(fp);
-            return -1;
+
+    int capacity = 0;
+    AttendanceRecord* records = NULL;
+    if (problem == NULL) {
+        records = attendance_list_alloc_loaded((int)count, &capacity);
+        if (!records)
+            problem = "out of memory";
+    }
+    if (problem == NULL) {
+        // One pass decodes straight out of the mapping, checksumming each
+        // chunk while it is still in cache
+        const unsigned char* p = data + ATTENDANCE_FILE_HEADER_SIZE;
+        uint32_t checksum = 1;
+        for (uint32_t i = 0; i < count; i += ATTENDANCE_FILE_CHUNK) {
+            uint32_t n = count - i < ATTENDANCE_FILE_CHUNK ? count - i : ATTENDANCE_FILE_CHUNK;
+            const unsigned char* chunk = p + (size_t)i * ATTENDANCE_FILE_RECORD_SIZE;
+            checksum = utils_hash_adler32(checksum, chunk, (size_t)n * ATTENDANCE_FILE_RECORD_SIZE);
+            for (uint32_t j = 0; j < n; j++)
+                attendance_decode_record(&records[i + j], chunk + (size_t)j * ATTENDANCE_FILE_RECORD_SIZE);
         }
-    } else {
-        list->records = NULL;
+        if (checksum != attendance_get_u32(data + 24))
+            problem = "records checksum mismatch";
     }
-    list->count = count;
-    list->capacity = (count > 0) ? count : 0;
-
-    fclose(fp);
-    return 0;
+    int next_id = (int)attendance_get_u32(data + 20);
+    utils_file_unmap(&mapped);
+    if (problem != NULL) {
+        printf("Warning: attendance file %s ignored: %s\n", filename, problem);
+        free(records);
+        return -1;
+    }
+    return attendance_list_adopt(list, records, (int)count, capacity, next_id);
 }
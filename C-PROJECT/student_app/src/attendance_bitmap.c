@@ -0,0 +1,386 @@
+#include "attendance_bitmap.h"
+#include "utils.h"
+#include <string.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static int attendance_bitmap_popcount(uint64_t word) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    return (int)__popcnt64(word);
+#elif defined(__GNUC__)
+    return __builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Position of the lowest set bit; word must not be 0
+static int attendance_bitmap_lowest_bit(uint64_t word) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long bit;
+    _BitScanForward64(&bit, word);
+    return (int)bit;
+#elif defined(__GNUC__)
+    return __builtin_ctzll(word);
+#else
+    return attendance_bitmap_popcount((word & (~word + 1)) - 1);
+#endif
+}
+
+// Grow one array to capacity elements; the caller commits the new capacity
+static int attendance_bitmap_grow(void** array, size_t element_size, int capacity) {
+    void* grown = realloc(*array, element_size * (size_t)capacity);
+    if (grown == NULL) {
+        return 0;
+    }
+    *array = grown;
+    return 1;
+}
+
+// Position of id in ids through index, or -1
+static int attendance_bitmap_find_id(const HashIndex* index, const int* ids, int id) {
+    HashIndexProbe probe;
+    int position;
+    hash_index_probe_begin(index, utils_hash_int(id), &probe);
+    while ((position = hash_index_probe_next(&probe)) >= 0) {
+        if (ids[position] == id) {
+            return position;
+        }
+    }
+    return -1;
+}
+
+static int attendance_bitmap_find_roster(const AttendanceBitmap* bitmap, int course_id) {
+    HashIndexProbe probe;
+    int roster;
+    hash_index_probe_begin(&bitmap->roster_index, utils_hash_int(course_id), &probe);
+    while ((roster = hash_index_probe_next(&probe)) >= 0) {
+        if (bitmap->rosters[roster].course_id == course_id) {
+            return roster;
+        }
+    }
+    return -1;
+}
+
+static void attendance_roster_free(AttendanceRoster* roster) {
+    free(roster->students);
+    free(roster->days);
+    free(roster->marked);
+    free(roster->attended);
+    hash_index_free(&roster->student_index);
+    hash_index_free(&roster->session_index);
+}
+
+// Roster of the course, added empty if new; NULL when out of memory
+static AttendanceRoster* attendance_bitmap_roster(AttendanceBitmap* bitmap, int course_id) {
+    int found = attendance_bitmap_find_roster(bitmap, course_id);
+    if (found >= 0) {
+        return &bitmap->rosters[found];
+    }
+    if (bitmap->roster_count >= bitmap->roster_capacity) {
+        int capacity = bitmap->roster_capacity > 0 ? bitmap->roster_capacity * 2 : 16;
+        if (!attendance_bitmap_grow((void**)&bitmap->rosters, sizeof(AttendanceRoster), capacity)) {
+            return NULL;
+        }
+        bitmap->roster_capacity = capacity;
+    }
+    if (!hash_index_insert(&bitmap->roster_index, utils_hash_int(course_id), bitmap->roster_count)) {
+        return NULL;
+    }
+    AttendanceRoster* roster = &bitmap->rosters[bitmap->roster_count++];
+    memset(roster, 0, sizeof(*roster));
+    roster->course_id = course_id;
+    hash_index_init(&roster->student_index);
+    hash_index_init(&roster->session_index);
+    return roster;
+}
+
+// Re-lay every session's bitsets at words per bitset
+static int attendance_roster_widen(AttendanceRoster* roster, int words) {
+    size_t total = (size_t)roster->session_capacity * (size_t)words;
+    uint64_t* marked = (uint64_t*)calloc(total > 0 ? total : 1, sizeof(uint64_t));
+    uint64_t* attended = (uint64_t*)calloc(total > 0 ? total : 1, sizeof(uint64_t));
+    if (marked == NULL || attended == NULL) {
+        free(marked);
+        free(attended);
+        return 0;
+    }
+    for (int s = 0; s < roster->session_count; s++) {
+        size_t from = (size_t)s * (size_t)roster->words;
+        size_t to = (size_t)s * (size_t)words;
+        memcpy(marked + to, roster->marked + from, sizeof(uint64_t) * (size_t)roster->words);
+        memcpy(attended + to, roster->attended + from, sizeof(uint64_t) * (size_t)roster->words);
+    }
+    free(roster->marked);
+    free(roster->attended);
+    roster->marked = marked;
+    roster->attended = attended;
+    roster->words = words;
+    return 1;
+}
+
+// Bit position of the student on the roster, added if new; -1 when out of memory
+static int attendance_roster_student(AttendanceRoster* roster, int student_id) {
+    int bit = attendance_bitmap_find_id(&roster->student_index, roster->students, student_id);
+    if (bit >= 0) {
+        return bit;
+    }
+    if (roster->student_count >= roster->student_capacity) {
+        int capacity = roster->student_capacity > 0 ? roster->student_capacity * 2 : 64;
+        if (!attendance_bitmap_grow((void**)&roster->students, sizeof(int), capacity)) {
+            return -1;
+        }
+        roster->student_capacity = capacity;
+    }
+    // Doubling the width keeps re-laying the sessions rare as the roster grows
+    if (roster->student_count >= roster->words * 64 &&
+        !attendance_roster_widen(roster, roster->words > 0 ? roster->words * 2 : 1)) {
+        return -1;
+    }
+    bit = roster->student_count;
+    if (!hash_index_insert(&roster->student_index, utils_hash_int(student_id), bit)) {
+        return -1;
+    }
+    roster->students[bit] = student_id;
+    roster->student_count++;
+    return bit;
+}
+
+// Session held on day, added with empty bitsets if new; -1 when out of memory
+static int attendance_roster_session(AttendanceRoster* roster, int day) {
+    int session = attendance_bitmap_find_id(&roster->session_index, roster->days, day);
+    if (session >= 0) {
+        return session;
+    }
+    if (roster->session_count >= roster->session_capacity) {
+        int capacity = roster->session_capacity > 0 ? roster->session_capacity * 2 : 16;
+        size_t words = (size_t)roster->words;
+        if (!attendance_bitmap_grow((void**)&roster->days, sizeof(int), capacity)) {
+            return -1;
+        }
+        if (words > 0) {
+            if (!attendance_bitmap_grow((void**)&roster->marked, sizeof(uint64_t) * words, capacity) ||
+                !attendance_bitmap_grow((void**)&roster->attended, sizeof(uint64_t) * words, capacity)) {
+                return -1;
+            }
+            size_t used = (size_t)roster->session_capacity * words;
+            size_t added = (size_t)(capacity - roster->session_capacity) * words;
+            memset(roster->marked + used, 0, sizeof(uint64_t) * added);
+            memset(roster->attended + used, 0, sizeof(uint64_t) * added);
+        }
+        roster->session_capacity = capacity;
+    }
+    session = roster->session_count;
+    if (!hash_index_insert(&roster->session_index, utils_hash_int(day), session)) {
+        return -1;
+    }
+    roster->days[session] = day;
+    roster->session_count++;
+    return session;
+}
+
+// Set the bits in set and clear those in clear; returns the previous flags
+static int attendance_roster_apply(AttendanceRoster* roster, int session, int bit, int set, int clear) {
+    size_t word = (size_t)session * (size_t)roster->words + (size_t)(bit >> 6);
+    uint64_t mask = (uint64_t)1 << (bit & 63);
+    int previous = ((roster->marked[word] & mask) ? ATTENDANCE_BITMAP_MARKED : 0) |
+                   ((roster->attended[word] & mask) ? ATTENDANCE_BITMAP_ATTENDED : 0);
+    if (clear & ATTENDANCE_BITMAP_MARKED) {
+        roster->marked[word] &= ~mask;
+    }
+    if (clear & ATTENDANCE_BITMAP_ATTENDED) {
+        roster->attended[word] &= ~mask;
+    }
+    if (set & ATTENDANCE_BITMAP_MARKED) {
+        roster->marked[word] |= mask;
+    }
+    if (set & ATTENDANCE_BITMAP_ATTENDED) {
+        roster->attended[word] |= mask;
+    }
+    return previous;
+}
+
+// Find the student's bit in the session without adding anything; 0 if any
+// of the three is unknown
+static int attendance_bitmap_lookup(const AttendanceBitmap* bitmap, int course_id, int day, int student_id,
+                                    int* roster, int* session, int* bit) {
+    *roster = attendance_bitmap_find_roster(bitmap, course_id);
+    if (*roster < 0) {
+        return 0;
+    }
+    const AttendanceRoster* r = &bitmap->rosters[*roster];
+    *session = attendance_bitmap_find_id(&r->session_index, r->days, day);
+    *bit = attendance_bitmap_find_id(&r->student_index, r->students, student_id);
+    return *session >= 0 && *bit >= 0;
+}
+
+void attendance_bitmap_init(AttendanceBitmap* bitmap) {
+    memset(bitmap, 0, sizeof(*bitmap));
+    hash_index_init(&bitmap->roster_index);
+}
+
+void attendance_bitmap_free(AttendanceBitmap* bitmap) {
+    if (bitmap == NULL) {
+        return;
+    }
+    for (int i = 0; i < bitmap->roster_count; i++) {
+        attendance_roster_free(&bitmap->rosters[i]);
+    }
+    free(bitmap->rosters);
+    hash_index_free(&bitmap->roster_index);
+    attendance_bitmap_init(bitmap);
+}
+
+// Roster, session and bit of the student, adding whichever are new; 0 when
+// out of memory
+static int attendance_bitmap_place(AttendanceBitmap* bitmap, int course_id, int day, int student_id,
+                                   AttendanceRoster** roster, int* session, int* bit) {
+    *roster = attendance_bitmap_roster(bitmap, course_id);
+    if (*roster == NULL) {
+        return 0;
+    }
+    *bit = attendance_roster_student(*roster, student_id);
+    *session = *bit >= 0 ? attendance_roster_session(*roster, day) : -1;
+    return *session >= 0;
+}
+
+// Add flags to the student's standing in the session
+int attendance_bitmap_add(AttendanceBitmap* bitmap, int course_id, int day, int student_id, int flags) {
+    if (bitmap == NULL) {
+        return -1;
+    }
+    if (flags == 0) {
+        return attendance_bitmap_flags(bitmap, course_id, day, student_id);
+    }
+    AttendanceRoster* roster;
+    int session, bit;
+    if (!attendance_bitmap_place(bitmap, course_id, day, student_id, &roster, &session, &bit)) {
+        return -1;
+    }
+    return attendance_roster_apply(roster, session, bit, flags, 0);
+}
+
+// Replace the student's standing in the session with flags. Clearing never
+// adds anything, so it cannot run out of memory.
+int attendance_bitmap_set(AttendanceBitmap* bitmap, int course_id, int day, int student_id, int flags) {
+    if (bitmap == NULL) {
+        return -1;
+    }
+    int all = ATTENDANCE_BITMAP_MARKED | ATTENDANCE_BITMAP_ATTENDED;
+    if (flags == 0) {
+        int roster, session, bit;
+        if (!attendance_bitmap_lookup(bitmap, course_id, day, student_id, &roster, &session, &bit)) {
+            return 0;
+        }
+        return attendance_roster_apply(&bitmap->rosters[roster], session, bit, 0, all);
+    }
+    AttendanceRoster* roster;
+    int session, bit;
+    if (!attendance_bitmap_place(bitmap, course_id, day, student_id, &roster, &session, &bit)) {
+        return -1;
+    }
+    return attendance_roster_apply(roster, session, bit, flags, all & ~flags);
+}
+
+// The student's standing in the session, 0 if never marked there
+int attendance_bitmap_flags(const AttendanceBitmap* bitmap, int course_id, int day, int student_id) {
+    int roster, session, bit;
+    if (bitmap == NULL || !attendance_bitmap_lookup(bitmap, course_id, day, student_id, &roster, &session, &bit)) {
+        return 0;
+    }
+    const AttendanceRoster* r = &bitmap->rosters[roster];
+    size_t word = (size_t)session * (size_t)r->words + (size_t)(bit >> 6);
+    uint64_t mask = (uint64_t)1 << (bit & 63);
+    return ((r->marked[word] & mask) ? ATTENDANCE_BITMAP_MARKED : 0) |
+           ((r->attended[word] & mask) ? ATTENDANCE_BITMAP_ATTENDED : 0);
+}
+
+// Students marked and attended in the session; returns 0, with both counts
+// 0, if the course never met that day
+int attendance_bitmap_session_counts(const AttendanceBitmap* bitmap, int course_id, int day, int* marked, int* attended) {
+    *marked = 0;
+    *attended = 0;
+    int roster = bitmap != NULL ? attendance_bitmap_find_roster(bitmap, course_id) : -1;
+    if (roster < 0) {
+        return 0;
+    }
+    const AttendanceRoster* r = &bitmap->rosters[roster];
+    int session = attendance_bitmap_find_id(&r->session_index, r->days, day);
+    if (session < 0) {
+        return 0;
+    }
+    const uint64_t* marked_row = r->marked + (size_t)session * (size_t)r->words;
+    const uint64_t* attended_row = r->attended + (size_t)session * (size_t)r->words;
+    for (int w = 0; w < r->words; w++) {
+        *marked += attendance_bitmap_popcount(marked_row[w]);
+        *attended += attendance_bitmap_popcount(attended_row[w]);
+    }
+    return 1;
+}
+
+// Fill student_ids with up to max_count students who attended the session;
+// returns how many attended in total
+int attendance_bitmap_attended_students(const AttendanceBitmap* bitmap, int course_id, int day, int* student_ids, int max_count) {
+    int roster = bitmap != NULL ? attendance_bitmap_find_roster(bitmap, course_id) : -1;
+    if (roster < 0) {
+        return 0;
+    }
+    const AttendanceRoster* r = &bitmap->rosters[roster];
+    int session = attendance_bitmap_find_id(&r->session_index, r->days, day);
+    if (session < 0) {
+        return 0;
+    }
+    const uint64_t* row = r->attended + (size_t)session * (size_t)r->words;
+    int count = 0;
+    for (int w = 0; w < r->words; w++) {
+        for (uint64_t bits = row[w]; bits != 0; bits &= bits - 1) {
+            if (student_ids != NULL && count < max_count) {
+                student_ids[count] = r->students[w * 64 + attendance_bitmap_lowest_bit(bits)];
+            }
+            count++;
+        }
+    }
+    return count;
+}
+
+// Returns 0, with both counts 0, if the student is not on the course's roster
+int attendance_bitmap_student_sessions(const AttendanceBitmap* bitmap, int course_id, int student_id, int* marked, int* attended) {
+    *marked = 0;
+    *attended = 0;
+    int roster = bitmap != NULL ? attendance_bitmap_find_roster(bitmap, course_id) : -1;
+    if (roster < 0) {
+        return 0;
+    }
+    const AttendanceRoster* r = &bitmap->rosters[roster];
+    int bit = attendance_bitmap_find_id(&r->student_index, r->students, student_id);
+    if (bit < 0) {
+        return 0;
+    }
+    uint64_t mask = (uint64_t)1 << (bit & 63);
+    for (int s = 0; s < r->session_count; s++) {
+        size_t word = (size_t)s * (size_t)r->words + (size_t)(bit >> 6);
+        *marked += (r->marked[word] & mask) != 0;
+        *attended += (r->attended[word] & mask) != 0;
+    }
+    return 1;
+}
+
+float attendance_bitmap_course_rate(const AttendanceBitmap* bitmap, int course_id) {
+    int roster = bitmap != NULL ? attendance_bitmap_find_roster(bitmap, course_id) : -1;
+    if (roster < 0) {
+        return -1;
+    }
+    const AttendanceRoster* r = &bitmap->rosters[roster];
+    size_t total = (size_t)r->session_count * (size_t)r->words;
+    long long marked = 0;
+    long long attended = 0;
+    for (size_t w = 0; w < total; w++) {
+        marked += attendance_bitmap_popcount(r->marked[w]);
+        attended += attendance_bitmap_popcount(r->attended[w]);
+    }
+    return marked > 0 ? (float)attended / marked * 100.0f : -1;
+}
@@ -0,0 +1,431 @@
+#include "attendance_partition.h"
+#include "attendance_store.h"
+#include <string.h>
+
+static int attendance_partition_month_of(time_t date) {
+    UtilsCivilDate civil;
+    return utils_date_civil(date, &civil) ? civil.year * 100 + civil.month : 0;
+}
+
+static void attendance_partition_path(const AttendancePartitionSet* set, int month, int archived, char* path, size_t size) {
+    snprintf(path, size, "%sattendance-%06d.%s", set->directory, month, archived ? "cold" : "dat");
+}
+
+static void attendance_partition_manifest_path(const AttendancePartitionSet* set, char* path, size_t size) {
+    snprintf(path, size, "%s%s", set->directory, ATTENDANCE_PARTITION_MANIFEST);
+}
+
+// Index of the month, or -1 with *position set to where it would go
+static int attendance_partition_find(const AttendancePartitionSet* set, int month, int* position) {
+    int low = 0;
+    int high = set->count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (set->partitions[mid].month < month) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (position != NULL) {
+        *position = low;
+    }
+    return low < set->count && set->partitions[low].month == month ? low : -1;
+}
+
+static AttendancePartition* attendance_partition_insert(AttendancePartitionSet* set, int month, int position) {
+    if (set->count >= set->capacity) {
+        int capacity = set->capacity > 0 ? set->capacity * 2 : 16;
+        AttendancePartition* grown = (AttendancePartition*)realloc(set->partitions, sizeof(AttendancePartition) * (size_t)capacity);
+        if (grown == NULL) {
+            printf("Error: Failed to allocate memory for attendance partitions\n");
+            return NULL;
+        }
+        set->partitions = grown;
+        set->capacity = capacity;
+    }
+    memmove(&set->partitions[position + 1], &set->partitions[position],
+            sizeof(AttendancePartition) * (size_t)(set->count - position));
+    set->count++;
+    AttendancePartition* part = &set->partitions[position];
+    memset(part, 0, sizeof(*part));
+    part->month = month;
+    return part;
+}
+
+// Read the month's file into part->list unless it is already there
+static int attendance_partition_load(AttendancePartitionSet* set, AttendancePartition* part) {
+    if (part->list != NULL) {
+        return 1;
+    }
+    AttendanceList* list = attendance_list_create();
+    if (list == NULL) {
+        printf("Error: Failed to allocate memory for attendance partition %06d\n", part->month);
+        return 0;
+    }
+    char path[UTILS_MAX_PATH_LENGTH];
+    attendance_partition_path(set, part->month, part->archived, path, sizeof(path));
+    int ok;
+    if (part->archived) {
+        AttendanceStore store;
+        attendance_store_init(&store);
+        ok = attendance_store_load(&store, path) == 0 && attendance_store_to_list(&store, list);
+        attendance_store_free(&store);
+    } else {
+        ok = attendance_list_load_from_file(list, path) == 0;
+    }
+    if (!ok) {
+        printf("Error: Failed to load attendance partition %s\n", path);
+        attendance_list_destroy(list);
+        return 0;
+    }
+    part->list = list;
+    if (list->next_id > set->next_id) {
+        set->next_id = list->next_id;
+    }
+    return 1;
+}
+
+// Save part->list in its format if it has changed since it was loaded
+static int attendance_partition_write(const AttendancePartitionSet* set, AttendancePartition* part) {
+    if (part->list == NULL || !part->dirty) {
+        return 1;
+    }
+    char path[UTILS_MAX_PATH_LENGTH];
+    attendance_partition_path(set, part->month, part->archived, path, sizeof(path));
+    int ok;
+    if (part->archived) {
+        AttendanceStore store;
+        attendance_store_init(&store);
+        ok = attendance_store_from_list(&store, part->list) && attendance_store_save(&store, path) == 0;
+        attendance_store_free(&store);
+    } else {
+        ok = attendance_list_save_to_file(part->list, path) == 0;
+    }
+    if (!ok) {
+        printf("Error: Failed to save attendance partition %s\n", path);
+        return 0;
+    }
+    part->dirty = 0;
+    return 1;
+}
+
+static void attendance_partition_unload(AttendancePartition* part) {
+    attendance_list_destroy(part->list);
+    part->list = NULL;
+}
+
+// Loaded partition of the month holding date, or NULL if there is none
+static AttendancePartition* attendance_partition_loaded(AttendancePartitionSet* set, time_t date) {
+    if (set == NULL) {
+        return NULL;
+    }
+    int index = attendance_partition_find(set, attendance_partition_month_of(date), NULL);
+    if (index < 0 || !attendance_partition_load(set, &set->partitions[index])) {
+        return NULL;
+    }
+    return &set->partitions[index];
+}
+
+// Loaded partition of the month holding date, created empty if new, and
+// flagged for saving since the caller is about to write to it
+static AttendancePartition* attendance_partition_for_write(AttendancePartitionSet* set, time_t date) {
+    int month = attendance_partition_month_of(date);
+    int position;
+    int index = attendance_partition_find(set, month, &position);
+    AttendancePartition* part;
+    if (index >= 0) {
+        part = &set->partitions[index];
+        if (!attendance_partition_load(set, part)) {
+            return NULL;
+        }
+    } else {
+        part = attendance_partition_insert(set, month, position);
+        if (part == NULL) {
+            return NULL;
+        }
+        part->list = attendance_list_create();
+        if (part->list == NULL) {
+            memmove(part, part + 1, sizeof(AttendancePartition) * (size_t)(set->count - position - 1));
+            set->count--;
+            return NULL;
+        }
+    }
+    part->dirty = 1;
+    return part;
+}
+
+static int attendance_partition_load_manifest(AttendancePartitionSet* set) {
+    char path[UTILS_MAX_PATH_LENGTH];
+    attendance_partition_manifest_path(set, path, sizeof(path));
+    if (!utils_file_exists(path)) {
+        return 0;
+    }
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        printf("Error: Could not open %s\n", path);
+        return -1;
+    }
+    char magic[16];
+    int version;
+    int result = 0;
+    if (fscanf(file, "%15s %d %d", magic, &version, &set->next_id) != 3 ||
+        strcmp(magic, ATTENDANCE_PARTITION_MAGIC) != 0 || version != ATTENDANCE_PARTITION_VERSION) {
+        printf("Error: %s is not an attendance partition manifest\n", path);
+        result = -1;
+    }
+    int month;
+    int archived;
+    while (result == 0 && fscanf(file, "%d %d", &month, &archived) == 2) {
+        int position;
+        AttendancePartition* part = NULL;
+        if (attendance_partition_find(set, month, &position) < 0) {
+            part = attendance_partition_insert(set, month, position);
+        }
+        if (part == NULL) {
+            result = -1;
+            break;
+        }
+        part->archived = archived != 0;
+    }
+    fclose(file);
+    return result;
+}
+
+static int attendance_partition_save_manifest(const AttendancePartitionSet* set) {
+    char path[UTILS_MAX_PATH_LENGTH];
+    attendance_partition_manifest_path(set, path, sizeof(path));
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        printf("Error: Could not open %s for writing\n", path);
+        return -1;
+    }
+    fprintf(file, "%s %d %d\n", ATTENDANCE_PARTITION_MAGIC, ATTENDANCE_PARTITION_VERSION, set->next_id);
+    for (int i = 0; i < set->count; i++) {
+        fprintf(file, "%06d %d\n", set->partitions[i].month, set->partitions[i].archived);
+    }
+    return fclose(file) == 0 ? 0 : -1;
+}
+
+// Open the partitioned history kept in directory, creating the directory if
+// needed. Only the manifest is read; months load as they are used.
+int attendance_partitions_open(AttendancePartitionSet* set, const char* directory) {
+    if (set == NULL || directory == NULL) {
+        return -1;
+    }
+    memset(set, 0, sizeof(*set));
+    set->next_id = 1;
+    size_t length = strlen(directory);
+    if (length == 0 || length + 2 > sizeof(set->directory)) {
+        printf("Error: Invalid attendance directory\n");
+        return -1;
+    }
+    strcpy(set->directory, directory);
+    if (directory[length - 1] != '/' && directory[length - 1] != '\\') {
+        strcat(set->directory, "/");
+    }
+    if (!utils_file_directory_exists(set->directory) && !utils_file_create_directory(set->directory)) {
+        printf("Error: Could not create %s\n", set->directory);
+        return -1;
+    }
+    if (attendance_partition_load_manifest(set) != 0) {
+        attendance_partitions_free(set);
+        return -1;
+    }
+    return 0;
+}
+
+// Write every changed month, then the manifest
+int attendance_partitions_save(AttendancePartitionSet* set) {
+    if (set == NULL) {
+        return -1;
+    }
+    int result = 0;
+    for (int i = 0; i < set->count; i++) {
+        if (!attendance_partition_write(set, &set->partitions[i])) {
+            result = -1;
+        }
+    }
+    if (attendance_partition_save_manifest(set) != 0) {
+        result = -1;
+    }
+    return result;
+}
+
+// Release everything without saving
+void attendance_partitions_free(AttendancePartitionSet* set) {
+    if (set == NULL) {
+        return;
+    }
+    for (int i = 0; i < set->count; i++) {
+        attendance_partition_unload(&set->partitions[i]);
+    }
+    free(set->partitions);
+    set->partitions = NULL;
+    set->count = 0;
+    set->capacity = 0;
+}
+
+// Spread the live records of a flat list over their months, keeping ids
+int attendance_partitions_import(AttendancePartitionSet* set, AttendanceList* list) {
+    if (set == NULL || list == NULL) {
+        return -1;
+    }
+    for (int i = 0; i < list->count; i++) {
+        AttendanceRecord* record = &list->records[i];
+        if (record->id == TOMBSTONE_ID) {
+            continue;
+        }
+        AttendancePartition* part = attendance_partition_for_write(set, record->date);
+        if (part == NULL) {
+            return -1;
+        }
+        // attendance_list_add does not grow the list itself
+        AttendanceList* month = part->list;
+        if (month->count >= month->capacity) {
+            int capacity = month->capacity * 2 + 1;
+            AttendanceRecord* records = (AttendanceRecord*)realloc(month->records, sizeof(AttendanceRecord) * (size_t)capacity);
+            if (records == NULL) {
+                printf("Error: Failed to allocate memory for attendance records\n");
+                return -1;
+            }
+            month->records = records;
+            month->capacity = capacity;
+        }
+        if (!attendance_list_add(month, *record)) {
+            return -1;
+        }
+        if (month->next_id > set->next_id) {
+            set->next_id = month->next_id;
+        }
+    }
+    if (list->next_id > set->next_id) {
+        set->next_id = list->next_id;
+    }
+    return 0;
+}
+
+AttendanceList* attendance_partitions_month(AttendancePartitionSet* set, time_t date) {
+    AttendancePartition* part = attendance_partition_loaded(set, date);
+    return part != NULL ? part->list : NULL;
+}
+
+// mark_attendance into the month of date, with an id from the shared sequence
+int attendance_partitions_mark(AttendancePartitionSet* set, int student_id, int course_id, time_t date, int status, int teacher_id) {
+    if (set == NULL) {
+        return -1;
+    }
+    AttendancePartition* part = attendance_partition_for_write(set, date);
+    if (part == NULL) {
+        return -1;
+    }
+    if (set->next_id > part->list->next_id) {
+        part->list->next_id = set->next_id;
+    }
+    int result = mark_attendance(part->list, student_id, course_id, date, status, teacher_id);
+    set->next_id = part->list->next_id;
+    return result;
+}
+
+// date is the session date of the record, which selects its month
+int attendance_partitions_update(AttendancePartitionSet* set, time_t date, int record_id, int new_status, const char* reason) {
+    AttendancePartition* part = attendance_partition_loaded(set, date);
+    if (part == NULL || update_attendance(part->list, record_id, new_status, reason) != 0) {
+        return -1;
+    }
+    part->dirty = 1;
+    return 0;
+}
+
+int attendance_partitions_remove(AttendancePartitionSet* set, time_t date, int record_id) {
+    AttendancePartition* part = attendance_partition_loaded(set, date);
+    if (part == NULL || !attendance_list_remove(part->list, record_id)) {
+        return -1;
+    }
+    part->dirty = 1;
+    return 0;
+}
+
+// get_attendance_for_date on the month of date alone
+int attendance_partitions_for_date(AttendancePartitionSet* set, int course_id, time_t date, AttendanceRecord** records, int* count) {
+    if (set == NULL || records == NULL || count == NULL) {
+        return -1;
+    }
+    int index = attendance_partition_find(set, attendance_partition_month_of(date), NULL);
+    if (index < 0) {
+        *records = NULL;
+        *count = 0;
+        return 0;
+    }
+    AttendancePartition* part = &set->partitions[index];
+    if (!attendance_partition_load(set, part)) {
+        return -1;
+    }
+    return get_attendance_for_date(part->list, course_id, date, records, count);
+}
+
+// Move every hot month before the month of cutoff to the cold format and
+// drop it from memory. The whole set, manifest included, is saved before
+// any hot file is deleted. Returns the number of months archived, or -1.
+int attendance_partitions_archive_before(AttendancePartitionSet* set, time_t cutoff) {
+    if (set == NULL) {
+        return -1;
+    }
+    int cutoff_month = attendance_partition_month_of(cutoff);
+    int archived = 0;
+    for (int i = 0; i < set->count && set->partitions[i].month < cutoff_month; i++) {
+        AttendancePartition* part = &set->partitions[i];
+        if (part->archived) {
+            continue;
+        }
+        if (!attendance_partition_load(set, part)) {
+            return -1;
+        }
+        int was_dirty = part->dirty;
+        part->archived = 1;
+        part->dirty = 1;
+        if (!attendance_partition_write(set, part)) {
+            part->archived = 0;
+            part->dirty = was_dirty;
+            return -1;
+        }
+        attendance_partition_unload(part);
+        archived++;
+    }
+    if (archived == 0) {
+        return 0;
+    }
+    if (attendance_partitions_save(set) != 0) {
+        return -1;
+    }
+    for (int i = 0; i < set->count && set->partitions[i].month < cutoff_month; i++) {
+        char path[UTILS_MAX_PATH_LENGTH];
+        attendance_partition_path(set, set->partitions[i].month, 0, path, sizeof(path));
+        if (set->partitions[i].archived && utils_file_exists(path)) {
+            utils_file_delete(path);
+        }
+    }
+    return archived;
+}
+
+// Save and release the loaded months before the month of cutoff; they load
+// again on the next access. Returns the number of months released, or -1.
+int attendance_partitions_unload_before(AttendancePartitionSet* set, time_t cutoff) {
+    if (set == NULL) {
+        return -1;
+    }
+    int cutoff_month = attendance_partition_month_of(cutoff);
+    int unloaded = 0;
+    for (int i = 0; i < set->count && set->partitions[i].month < cutoff_month; i++) {
+        AttendancePartition* part = &set->partitions[i];
+        if (part->list == NULL) {
+            continue;
+        }
+        if (!attendance_partition_write(set, part)) {
+            return -1;
+        }
+        attendance_partition_unload(part);
+        unloaded++;
+    }
+    return unloaded;
+}
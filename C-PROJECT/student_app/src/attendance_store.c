@@ -0,0 +1,569 @@
+#include "attendance_store.h"
+#include "utils.h"
+#include <string.h>
+#include <limits.h>
+
+#define ATTENDANCE_STORE_BYTE_ORDER 0x01020304u
+#define ATTENDANCE_STORE_DAY_SECONDS 86400
+
+// Split t into a day number and the seconds into that (UTC) day
+static long long attendance_store_split(time_t t, int* seconds) {
+    long long day = (long long)t / ATTENDANCE_STORE_DAY_SECONDS;
+    long long rest = (long long)t % ATTENDANCE_STORE_DAY_SECONDS;
+    if (rest < 0) {
+        rest += ATTENDANCE_STORE_DAY_SECONDS;
+        day--;
+    }
+    *seconds = (int)rest;
+    return day;
+}
+
+// Grow one column to capacity elements; the caller commits the new capacity
+static int attendance_store_grow(void** column, size_t element_size, int capacity) {
+    void* grown = realloc(*column, element_size * (size_t)capacity);
+    if (grown == NULL) {
+        return 0;
+    }
+    *column = grown;
+    return 1;
+}
+
+static int attendance_store_reserve_rows(AttendanceStore* store, int count) {
+    if (count <= store->capacity) {
+        return 1;
+    }
+    int capacity = store->capacity > 0 ? store->capacity : 64;
+    while (capacity < count) {
+        capacity *= 2;
+    }
+    if (!attendance_store_grow((void**)&store->ids, sizeof(int), capacity) ||
+        !attendance_store_grow((void**)&store->student_ids, sizeof(int), capacity) ||
+        !attendance_store_grow((void**)&store->course_refs, sizeof(unsigned short), capacity) ||
+        !attendance_store_grow((void**)&store->teacher_refs, sizeof(unsigned short), capacity) ||
+        !attendance_store_grow((void**)&store->day_offsets, sizeof(short), capacity) ||
+        !attendance_store_grow((void**)&store->time_status, sizeof(unsigned int), capacity) ||
+        !attendance_store_grow((void**)&store->recorded_offsets, sizeof(int), capacity)) {
+        printf("Error: Failed to allocate memory for attendance columns\n");
+        return 0;
+    }
+    store->capacity = capacity;
+    return 1;
+}
+
+// Reference of id in a dictionary, or -1
+static int attendance_store_find_ref(const HashIndex* index, const int* ids, int id) {
+    HashIndexProbe probe;
+    int ref;
+    hash_index_probe_begin(index, utils_hash_int(id), &probe);
+    while ((ref = hash_index_probe_next(&probe)) >= 0) {
+        if (ids[ref] == id) {
+            return ref;
+        }
+    }
+    return -1;
+}
+
+static int attendance_store_course_ref(AttendanceStore* store, int course_id, long long day) {
+    int ref = attendance_store_find_ref(&store->course_index, store->courses, course_id);
+    if (ref >= 0) {
+        return ref;
+    }
+    if (store->course_count >= ATTENDANCE_STORE_MAX_REFS) {
+        printf("Error: Too many courses for the attendance store\n");
+        return -1;
+    }
+    if (day < INT_MIN || day > INT_MAX) {
+        printf("Error: Attendance date out of range\n");
+        return -1;
+    }
+    if (store->course_count >= store->course_capacity) {
+        int capacity = store->course_capacity > 0 ? store->course_capacity * 2 : 16;
+        if (!attendance_store_grow((void**)&store->courses, sizeof(int), capacity) ||
+            !attendance_store_grow((void**)&store->course_base_days, sizeof(int), capacity)) {
+            printf("Error: Failed to allocate memory for attendance courses\n");
+            return -1;
+        }
+        store->course_capacity = capacity;
+    }
+    ref = store->course_count;
+    if (!hash_index_insert(&store->course_index, utils_hash_int(course_id), ref)) {
+        return -1;
+    }
+    store->courses[ref] = course_id;
+    store->course_base_days[ref] = (int)day;
+    store->course_count++;
+    return ref;
+}
+
+static int attendance_store_teacher_ref(AttendanceStore* store, int teacher_id) {
+    int ref = attendance_store_find_ref(&store->teacher_index, store->teachers, teacher_id);
+    if (ref >= 0) {
+        return ref;
+    }
+    if (store->teacher_count >= ATTENDANCE_STORE_MAX_REFS) {
+        printf("Error: Too many teachers for the attendance store\n");
+        return -1;
+    }
+    if (store->teacher_count >= store->teacher_capacity) {
+        int capacity = store->teacher_capacity > 0 ? store->teacher_capacity * 2 : 16;
+        if (!attendance_store_grow((void**)&store->teachers, sizeof(int), capacity)) {
+            printf("Error: Failed to allocate memory for attendance teachers\n");
+            return -1;
+        }
+        store->teacher_capacity = capacity;
+    }
+    ref = store->teacher_count;
+    if (!hash_index_insert(&store->teacher_index, utils_hash_int(teacher_id), ref)) {
+        return -1;
+    }
+    store->teachers[ref] = teacher_id;
+    store->teacher_count++;
+    return ref;
+}
+
+// Copy reason into the pool and list it for row
+static int attendance_store_add_reason(AttendanceStore* store, int row, const char* reason, size_t length) {
+    if (store->reasons_size + length + 1 > (size_t)INT_MAX) {
+        printf("Error: Attendance reason pool is full\n");
+        return 0;
+    }
+    if (store->reasons_size + length + 1 > store->reasons_capacity) {
+        size_t capacity = store->reasons_capacity > 0 ? store->reasons_capacity * 2 : 1024;
+        while (capacity < store->reasons_size + length + 1) {
+            capacity *= 2;
+        }
+        char* grown = (char*)realloc(store->reasons, capacity);
+        if (grown == NULL) {
+            printf("Error: Failed to allocate memory for attendance reasons\n");
+            return 0;
+        }
+        store->reasons = grown;
+        store->reasons_capacity = capacity;
+    }
+    if (store->reason_count >= store->reason_capacity) {
+        int capacity = store->reason_capacity > 0 ? store->reason_capacity * 2 : 16;
+        if (!attendance_store_grow((void**)&store->reason_rows, sizeof(int), capacity) ||
+            !attendance_store_grow((void**)&store->reason_offsets, sizeof(int), capacity)) {
+            printf("Error: Failed to allocate memory for attendance reasons\n");
+            return 0;
+        }
+        store->reason_capacity = capacity;
+    }
+    memcpy(store->reasons + store->reasons_size, reason, length);
+    store->reasons[store->reasons_size + length] = '\0';
+    store->reason_rows[store->reason_count] = row;
+    store->reason_offsets[store->reason_count] = (int)store->reasons_size;
+    store->reason_count++;
+    store->reasons_size += length + 1;
+    return 1;
+}
+
+void attendance_store_init(AttendanceStore* store) {
+    memset(store, 0, sizeof(*store));
+    hash_index_init(&store->course_index);
+    hash_index_init(&store->teacher_index);
+    store->next_id = 1;
+}
+
+void attendance_store_free(AttendanceStore* store) {
+    if (store == NULL) {
+        return;
+    }
+    free(store->ids);
+    free(store->student_ids);
+    free(store->course_refs);
+    free(store->teacher_refs);
+    free(store->day_offsets);
+    free(store->time_status);
+    free(store->recorded_offsets);
+    free(store->courses);
+    free(store->course_base_days);
+    free(store->teachers);
+    free(store->reason_rows);
+    free(store->reason_offsets);
+    free(store->reasons);
+    hash_index_free(&store->course_index);
+    hash_index_free(&store->teacher_index);
+    attendance_store_init(store);
+}
+
+// Append one record as a new row. Returns 0, leaving the store unchanged
+// apart from possibly new dictionary entries, if a field cannot be encoded.
+int attendance_store_append(AttendanceStore* store, const AttendanceRecord* record) {
+    if (store == NULL || record == NULL) {
+        return 0;
+    }
+    if (record->status < 0 || (unsigned int)record->status > ATTENDANCE_STORE_STATUS_MASK) {
+        printf("Error: Attendance status %d cannot be stored\n", record->status);
+        return 0;
+    }
+    long long recorded_offset = (long long)record->recorded_time - (long long)record->date;
+    if (recorded_offset < INT_MIN || recorded_offset > INT_MAX) {
+        printf("Error: Attendance record %d was recorded too far from its date\n", record->id);
+        return 0;
+    }
+    int seconds;
+    long long day = attendance_store_split(record->date, &seconds);
+    int course_ref = attendance_store_course_ref(store, record->course_id, day);
+    if (course_ref < 0) {
+        return 0;
+    }
+    long long day_offset = day - store->course_base_days[course_ref];
+    if (day_offset < SHRT_MIN || day_offset > SHRT_MAX) {
+        printf("Error: Attendance record %d is too far from the course's first session\n", record->id);
+        return 0;
+    }
+    int teacher_ref = attendance_store_teacher_ref(store, record->teacher_id);
+    if (teacher_ref < 0 || !attendance_store_reserve_rows(store, store->count + 1)) {
+        return 0;
+    }
+
+    int row = store->count;
+    size_t length = strnlen(record->reason, sizeof(record->reason) - 1);
+    if (length > 0 && !attendance_store_add_reason(store, row, record->reason, length)) {
+        return 0;
+    }
+    store->ids[row] = record->id;
+    store->student_ids[row] = record->student_id;
+    store->course_refs[row] = (unsigned short)course_ref;
+    store->teacher_refs[row] = (unsigned short)teacher_ref;
+    store->day_offsets[row] = (short)day_offset;
+    store->time_status[row] = ((unsigned int)seconds << ATTENDANCE_STORE_STATUS_BITS) | (unsigned int)record->status;
+    store->recorded_offsets[row] = (int)recorded_offset;
+    store->count++;
+    if (record->id >= store->next_id) {
+        store->next_id = record->id + 1;
+    }
+    return 1;
+}
+
+int attendance_store_status(const AttendanceStore* store, int row) {
+    return (int)(store->time_status[row] & ATTENDANCE_STORE_STATUS_MASK);
+}
+
+time_t attendance_store_date(const AttendanceStore* store, int row) {
+    long long day = (long long)store->course_base_days[store->course_refs[row]] + store->day_offsets[row];
+    return (time_t)(day * ATTENDANCE_STORE_DAY_SECONDS + (store->time_status[row] >> ATTENDANCE_STORE_STATUS_BITS));
+}
+
+// Reason of row, or "" if it has none
+const char* attendance_store_reason(const AttendanceStore* store, int row) {
+    int low = 0;
+    int high = store->reason_count - 1;
+    while (low <= high) {
+        int mid = low + (high - low) / 2;
+        if (store->reason_rows[mid] == row) {
+            return store->reasons + store->reason_offsets[mid];
+        }
+        if (store->reason_rows[mid] < row) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return "";
+}
+
+// Expand row back into a full record
+int attendance_store_get(const AttendanceStore* store, int row, AttendanceRecord* record) {
+    if (store == NULL || record == NULL || row < 0 || row >= store->count) {
+        return 0;
+    }
+    memset(record, 0, sizeof(*record));
+    record->id = store->ids[row];
+    record->student_id = store->student_ids[row];
+    record->course_id = store->courses[store->course_refs[row]];
+    record->teacher_id = store->teachers[store->teacher_refs[row]];
+    record->status = attendance_store_status(store, row);
+    record->date = attendance_store_date(store, row);
+    record->recorded_time = record->date + store->recorded_offsets[row];
+    strncpy(record->reason, attendance_store_reason(store, row), sizeof(record->reason) - 1);
+    return 1;
+}
+
+// Bytes held by the store, for comparison with count * sizeof(AttendanceRecord)
+size_t attendance_store_memory(const AttendanceStore* store) {
+    size_t row_size = sizeof(int) * 3 + sizeof(unsigned short) * 2 + sizeof(short) + sizeof(unsigned int);
+    return sizeof(*store) +
+           row_size * (size_t)store->capacity +
+           sizeof(int) * 2 * (size_t)store->course_capacity +
+           sizeof(int) * (size_t)store->teacher_capacity +
+           sizeof(int) * 2 * (size_t)store->reason_capacity +
+           store->reasons_capacity +
+           sizeof(HashIndexEntry) * (size_t)(store->course_index.capacity + store->teacher_index.capacity);
+}
+
+// Replace the store's rows with the live records of list
+int attendance_store_from_list(AttendanceStore* store, AttendanceList* list) {
+    if (store == NULL || list == NULL) {
+        return 0;
+    }
+    attendance_store_free(store);
+    if (!attendance_store_reserve_rows(store, list->count)) {
+        return 0;
+    }
+    for (int i = 0; i < list->count; i++) {
+        if (list->records[i].id == TOMBSTONE_ID) {
+            continue;
+        }
+        if (!attendance_store_append(store, &list->records[i])) {
+            attendance_store_free(store);
+            return 0;
+        }
+    }
+    if (list->next_id > store->next_id) {
+        store->next_id = list->next_id;
+    }
+    return 1;
+}
+
+// Replace the records of list with the store's rows
+int attendance_store_to_list(const AttendanceStore* store, AttendanceList* list) {
+    if (store == NULL || list == NULL) {
+        return 0;
+    }
+    if (store->count > list->capacity) {
+        AttendanceRecord* records = (AttendanceRecord*)realloc(list->records, sizeof(AttendanceRecord) * (size_t)store->count);
+        if (records == NULL) {
+            printf("Error: Failed to allocate memory for attendance records\n");
+            return 0;
+        }
+        list->records = records;
+        list->capacity = store->count;
+    }
+    list->count = 0;
+    free_slots_clear(&list->free_slots);
+    hash_index_clear(&list->id_index);
+    hash_index_clear(&list->student_day_index);
+    hash_index_clear(&list->course_day_index);
+    list->tally.stale = 1;   // Recounted from the new rows on the next read
+    list->bitmap.stale = 1;
+    // attendance_list_add indexes each record and advances next_id past it
+    for (int row = 0; row < store->count; row++) {
+        AttendanceRecord record;
+        attendance_store_get(store, row, &record);
+        if (!attendance_list_add(list, record)) {
+            return 0;
+        }
+    }
+    if (store->next_id > list->next_id) {
+        list->next_id = store->next_id;
+    }
+    return 1;
+}
+
+#define ATTENDANCE_STORE_COLUMNS 13
+
+// Columns in file order, with the number of bytes each occupies
+typedef struct {
+    void* data;
+    size_t size;
+} AttendanceStoreColumn;
+
+static int attendance_store_columns(const AttendanceStore* store, AttendanceStoreColumn* columns) {
+    size_t rows = (size_t)store->count;
+    size_t courses = (size_t)store->course_count;
+    size_t reasons = (size_t)store->reason_count;
+    AttendanceStoreColumn layout[ATTENDANCE_STORE_COLUMNS] = {
+        {store->ids, sizeof(int) * rows},
+        {store->student_ids, sizeof(int) * rows},
+        {store->course_refs, sizeof(unsigned short) * rows},
+        {store->teacher_refs, sizeof(unsigned short) * rows},
+        {store->day_offsets, sizeof(short) * rows},
+        {store->time_status, sizeof(unsigned int) * rows},
+        {store->recorded_offsets, sizeof(int) * rows},
+        {store->courses, sizeof(int) * courses},
+        {store->course_base_days, sizeof(int) * courses},
+        {store->teachers, sizeof(int) * (size_t)store->teacher_count},
+        {store->reason_rows, sizeof(int) * reasons},
+        {store->reason_offsets, sizeof(int) * reasons},
+        {store->reasons, store->reasons_size},
+    };
+    memcpy(columns, layout, sizeof(layout));
+    return ATTENDANCE_STORE_COLUMNS;
+}
+
+int attendance_store_save(const AttendanceStore* store, const char* filename) {
+    if (store == NULL || filename == NULL)
+        return -1;
+
+    AttendanceStoreHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ATTENDANCE_STORE_MAGIC, sizeof(ATTENDANCE_STORE_MAGIC));
+    header.byte_order = ATTENDANCE_STORE_BYTE_ORDER;
+    header.version = ATTENDANCE_STORE_VERSION;
+    header.count = store->count;
+    header.course_count = store->course_count;
+    header.teacher_count = store->teacher_count;
+    header.reason_count = store->reason_count;
+    header.reasons_size = (unsigned int)store->reasons_size;
+    header.next_id = store->next_id;
+
+    AttendanceStoreColumn columns[ATTENDANCE_STORE_COLUMNS];
+    int column_count = attendance_store_columns(store, columns);
+    header.checksum = 1;
+    for (int i = 0; i < column_count; i++) {
+        header.checksum = utils_hash_adler32(header.checksum, columns[i].data, columns[i].size);
+    }
+
+    FILE* fp = fopen(filename, "wb");
+    if (!fp)
+        return -1;
+    int ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    for (int i = 0; ok && i < column_count; i++) {
+        ok = columns[i].size == 0 || fwrite(columns[i].data, 1, columns[i].size, fp) == columns[i].size;
+    }
+    if (fclose(fp) != 0)
+        ok = 0;
+    if (!ok) {
+        remove(filename);
+        return -1;
+    }
+    return 0;
+}
+
+// Check that every reference in the loaded columns points inside its
+// dictionary or pool. Returns what is wrong, or NULL.
+static const char* attendance_store_check(const AttendanceStore* store) {
+    for (int row = 0; row < store->count; row++) {
+        if (store->course_refs[row] >= store->course_count) {
+            return "course reference out of range";
+        }
+        if (store->teacher_refs[row] >= store->teacher_count) {
+            return "teacher reference out of range";
+        }
+        if ((store->time_status[row] >> ATTENDANCE_STORE_STATUS_BITS) >= ATTENDANCE_STORE_DAY_SECONDS) {
+            return "time of day out of range";
+        }
+    }
+    if (store->reason_count > 0 &&
+        (store->reasons_size == 0 || store->reasons[store->reasons_size - 1] != '\0')) {
+        return "reason pool not terminated";
+    }
+    for (int i = 0; i < store->reason_count; i++) {
+        // attendance_store_reason binary-searches the rows
+        if (store->reason_rows[i] < 0 || store->reason_rows[i] >= store->count ||
+            (i > 0 && store->reason_rows[i] <= store->reason_rows[i - 1])) {
+            return "reason rows out of order or out of range";
+        }
+        if (store->reason_offsets[i] < 0 || (size_t)store->reason_offsets[i] >= store->reasons_size) {
+            return "reason offset out of range";
+        }
+    }
+    return NULL;
+}
+
+int attendance_store_load(AttendanceStore* store, const char* filename) {
+    if (store == NULL || filename == NULL)
+        return -1;
+
+    UtilsMappedFile mapped;
+    if (!utils_file_map(filename, &mapped))
+        return -1;
+
+    AttendanceStoreHeader header;
+    const char* problem = NULL;
+    if (mapped.size < sizeof(header)) {
+        problem = "file too short";
+    } else {
+        memcpy(&header, mapped.data, sizeof(header));
+        if (memcmp(header.magic, ATTENDANCE_STORE_MAGIC, sizeof(ATTENDANCE_STORE_MAGIC)) != 0) {
+            problem = "not an attendance store";
+        } else if (header.byte_order != ATTENDANCE_STORE_BYTE_ORDER) {
+            problem = "written on a machine with a different byte order";
+        } else if (header.version != ATTENDANCE_STORE_VERSION) {
+            problem = "unsupported version";
+        } else if (header.count < 0 || header.course_count < 0 || header.course_count > ATTENDANCE_STORE_MAX_REFS ||
+                   header.teacher_count < 0 || header.teacher_count > ATTENDANCE_STORE_MAX_REFS ||
+                   header.reason_count < 0 || header.reason_count > header.count) {
+            problem = "corrupt header";
+        }
+    }
+    if (problem == NULL) {
+        // Size the columns from the header, then check they fill the file exactly
+        AttendanceStore sizes;
+        memset(&sizes, 0, sizeof(sizes));
+        sizes.count = header.count;
+        sizes.course_count = header.course_count;
+        sizes.teacher_count = header.teacher_count;
+        sizes.reason_count = header.reason_count;
+        sizes.reasons_size = header.reasons_size;
+        AttendanceStoreColumn columns[ATTENDANCE_STORE_COLUMNS];
+        int column_count = attendance_store_columns(&sizes, columns);
+        size_t body = 0;
+        for (int i = 0; i < column_count; i++) {
+            body += columns[i].size;
+        }
+        if (mapped.size - sizeof(header) != body) {
+            problem = "column sizes do not match file size";
+        } else if (utils_hash_adler32(1, mapped.data + sizeof(header), body) != header.checksum) {
+            problem = "checksum mismatch";
+        }
+    }
+    if (problem != NULL) {
+        printf("Warning: attendance store %s ignored: %s\n", filename, problem);
+        utils_file_unmap(&mapped);
+        return -1;
+    }
+
+    attendance_store_free(store);
+    int ok = attendance_store_reserve_rows(store, header.count);
+    if (ok && header.course_count > 0) {
+        ok = attendance_store_grow((void**)&store->courses, sizeof(int), header.course_count) &&
+             attendance_store_grow((void**)&store->course_base_days, sizeof(int), header.course_count);
+        store->course_capacity = ok ? header.course_count : 0;
+    }
+    if (ok && header.teacher_count > 0) {
+        ok = attendance_store_grow((void**)&store->teachers, sizeof(int), header.teacher_count);
+        store->teacher_capacity = ok ? header.teacher_count : 0;
+    }
+    if (ok && header.reason_count > 0) {
+        ok = attendance_store_grow((void**)&store->reason_rows, sizeof(int), header.reason_count) &&
+             attendance_store_grow((void**)&store->reason_offsets, sizeof(int), header.reason_count);
+        store->reason_capacity = ok ? header.reason_count : 0;
+    }
+    if (ok && header.reasons_size > 0) {
+        ok = attendance_store_grow((void**)&store->reasons, 1, (int)header.reasons_size);
+        store->reasons_capacity = ok ? header.reasons_size : 0;
+    }
+    if (ok) {
+        store->count = header.count;
+        store->course_count = header.course_count;
+        store->teacher_count = header.teacher_count;
+        store->reason_count = header.reason_count;
+        store->reasons_size = header.reasons_size;
+        store->next_id = header.next_id;
+
+        AttendanceStoreColumn columns[ATTENDANCE_STORE_COLUMNS];
+        int column_count = attendance_store_columns(store, columns);
+        const char* data = mapped.data + sizeof(header);
+        for (int i = 0; i < column_count; i++) {
+            if (columns[i].size > 0) {
+                memcpy(columns[i].data, data, columns[i].size);
+            }
+            data += columns[i].size;
+        }
+        problem = attendance_store_check(store);
+        ok = problem == NULL &&
+             hash_index_reserve(&store->course_index, store->course_count) &&
+             hash_index_reserve(&store->teacher_index, store->teacher_count);
+        for (int ref = 0; ok && ref < store->course_count; ref++) {
+            ok = hash_index_insert(&store->course_index, utils_hash_int(store->courses[ref]), ref);
+        }
+        for (int ref = 0; ok && ref < store->teacher_count; ref++) {
+            ok = hash_index_insert(&store->teacher_index, utils_hash_int(store->teachers[ref]), ref);
+        }
+    }
+    utils_file_unmap(&mapped);
+    if (problem != NULL) {
+        printf("Warning: attendance store %s ignored: %s\n", filename, problem);
+        attendance_store_free(store);
+        return -1;
+    }
+    if (!ok) {
+        printf("Error: Failed to allocate memory for attendance store %s\n", filename);
+        attendance_store_free(store);
+        return -1;
+    }
+    return 0;
+}
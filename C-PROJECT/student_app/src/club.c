@@ -8,12 +8,41 @@
 #include "attendance.h"
 #include "grade.h"
 #include "club.h"
+#include "utils.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <sys/time.h>
 
+// Position of the earliest club with this id, or -1
+static int club_list_slot_of_id(const ClubList* list, int club_id){
+    int found = -1;
+    HashIndexProbe probe;
+    int slot;
+    hash_index_probe_begin(&list->id_index, utils_hash_int(club_id), &probe);
+    while((slot = hash_index_probe_next(&probe)) >= 0){
+        if(slot < list->count && (found < 0 || slot < found) &&
+           list->clubs[slot].id == club_id){
+            found = slot;
+        }
+    }
+    return found;
+}
+// Rebuild the id index after clubs have been moved or reloaded
+static int club_list_rebuild_index(ClubList* list){
+    hash_index_clear(&list->id_index);
+    if(!hash_index_reserve(&list->id_index, list->count)){
+        return 0;
+    }
+    for(int i = 0; i < list->count; i++){
+        if(list->clubs[i].id != TOMBSTONE_ID &&
+           !hash_index_insert(&list->id_index, utils_hash_int(list->clubs[i].id), i)){
+            return 0;
+        }
+    }
+    return 1;
+}
 ClubList* club_list_create(void){
     ClubList* list = (ClubList*)malloc(sizeof(ClubList));
     if(list == NULL){
@@ -29,6 +58,8 @@ ClubList* club_list_create(void){
     list->clubs = clubs;
     list->count = 0;
     list->capacity = MAX_CLUBS;
+    free_slots_init(&list->free_slots);
+    hash_index_init(&list->id_index);
     return list;    
 
 }
@@ -39,6 +70,8 @@ void club_list_destroy(ClubList* list){
     if(list->clubs != NULL){
         free(list->clubs);
     }
+    free_slots_free(&list->free_slots);
+    hash_index_free(&list->id_index);
     free(list);
 }
 
@@ -46,39 +79,75 @@ int club_list_add(ClubList* list, Club new_club){
     if(list == NULL || list->clubs == NULL){
         return 0;
     }
-    if(list->count >= list->capacity){
-        printf("error: club list is full\n");
+    // Reuse a tombstoned slot first
+    int slot = free_slots_pop(&list->free_slots);
+    while(slot >= 0 && (slot >= list->count || list->clubs[slot].id != TOMBSTONE_ID)){
+        slot = free_slots_pop(&list->free_slots);
+    }
+    if(slot < 0){
+        if(list->count >= list->capacity){
+            printf("error: club list is full\n");
+            return 0;
+        }
+        slot = list->count++;
+    }
+    list->clubs[slot] = new_club;
+    if(!hash_index_insert(&list->id_index, utils_hash_int(new_club.id), slot)){
+        printf("error: failed to index club %d\n", new_club.id);
+        list->clubs[slot].id = TOMBSTONE_ID;
+        free_slots_push(&list->free_slots, slot);
         return 0;
     }
-    list->clubs[list->count] = new_club;
-    list->count++;
     return 1;
 }
 int club_list_remove(ClubList* list, int club_id){
     if(list == NULL || list->clubs == NULL){
         return 0;
     }
+    int i = club_list_slot_of_id(list, club_id);
+    if(i < 0){
+        return 0;
+    }
+    // Tombstone instead of shifting the clubs behind it
+    hash_index_remove(&list->id_index, utils_hash_int(club_id), i);
+    memset(&list->clubs[i], 0, sizeof(Club));
+    list->clubs[i].id = TOMBSTONE_ID;
+    if(!free_slots_push(&list->free_slots, i) ||
+       free_slots_should_compact(&list->free_slots, list->count)){
+        club_list_compact(list);
+    }
+    return 1;
+}
+// Squeeze out tombstones, keeping the remaining clubs in order
+void club_list_compact(ClubList* list){
+    if(list == NULL || list->clubs == NULL){
+        return;
+    }
+    int live = 0;
     for(int i = 0; i < list->count; i++){
-        if(list->clubs[i].id == club_id){
-            for(int j = i; j < list->count - 1; j++){
-                list->clubs[j] = list->clubs[j + 1];
-            }
-            memset(&list->clubs[list->count - 1], 0, sizeof(Club));
-            list->count--;
-            return 1;
+        if(list->clubs[i].id == TOMBSTONE_ID){
+            continue;
+        }
+        if(i != live){
+            list->clubs[live] = list->clubs[i];
         }
+        live++;
+    }
+    int moved = live != list->count;
+    list->count = live;
+    free_slots_clear(&list->free_slots);
+    if(moved && !club_list_rebuild_index(list)){
+        printf("error: failed to rebuild the club index\n");
     }
-    return 0;
 }
 Club* club_list_find_by_id(ClubList* list, int club_id){
     if(list == NULL || list->clubs == NULL){
         printf("list is null\n");
         return NULL;
     }
-    for(int i = 0; i < list->count; i++){
-        if(list->clubs[i].id == club_id){
-            return &list->clubs[i];
-        }
+    int slot = club_list_slot_of_id(list, club_id);
+    if(slot >= 0){
+        return &list->clubs[slot];
     }
     printf("club with id %d not found\n", club_id);
     return NULL;
@@ -89,7 +158,7 @@ Club* club_list_find_by_name(ClubList* list, const char* name){
         return NULL;
     }
     for(int i = 0; i < list->count; i++){
-        if(strcmp(list->clubs[i].name, name) == 0){
+        if(list->clubs[i].id != TOMBSTONE_ID && strcmp(list->clubs[i].name, name) == 0){
             return &list->clubs[i];
         }
     }
@@ -101,8 +170,12 @@ void club_list_display_all(ClubList* list){
         printf("list is null\n");
         return;
     }
+  int shown = 0;
   for(int i = 0; i < list->count; i++){
-    printf("\nClub %d:\n", i + 1);
+    if(list->clubs[i].id == TOMBSTONE_ID){
+        continue;
+    }
+    printf("\nClub %d:\n", ++shown);
     printf("ID: %d\n", list->clubs[i].id);
     printf("Name: %s\n", list->clubs[i].name);
     printf("Description: %s\n", list->clubs[i].description);
@@ -142,6 +215,36 @@ void club_list_display_club(Club* club){
 
 
 
+// Position of the earliest membership with this id, or -1
+static int membership_list_slot_of_id(const MembershipList* list, int membership_id) {
+    int found = -1;
+    HashIndexProbe probe;
+    int slot;
+    hash_index_probe_begin(&list->id_index, utils_hash_int(membership_id), &probe);
+    while ((slot = hash_index_probe_next(&probe)) >= 0) {
+        if (slot < list->count && (found < 0 || slot < found) &&
+            list->memberships[slot].id == membership_id) {
+            found = slot;
+        }
+    }
+    return found;
+}
+
+// Rebuild the id index after memberships have been moved or reloaded
+static int membership_list_rebuild_index(MembershipList* list) {
+    hash_index_clear(&list->id_index);
+    if (!hash_index_reserve(&list->id_index, list->count)) {
+        return 0;
+    }
+    for (int i = 0; i < list->count; i++) {
+        if (list->memberships[i].id != TOMBSTONE_ID &&
+            !hash_index_insert(&list->id_index, utils_hash_int(list->memberships[i].id), i)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
 MembershipList* membership_list_create(void) {
     MembershipList* list = (MembershipList*)malloc(sizeof(MembershipList));
     if (list == NULL) {
@@ -156,6 +259,8 @@ MembershipList* membership_list_create(void) {
         free(list);
         return NULL;
     }
+    free_slots_init(&list->free_slots);
+    hash_index_init(&list->id_index);
     return list;
 }
 
@@ -166,6 +271,8 @@ void membership_list_destroy(MembershipList* list) {
     if (list->memberships != NULL) {
         free(list->memberships);
     }
+    free_slots_free(&list->free_slots);
+    hash_index_free(&list->id_index);
     free(list);
 }
 
@@ -175,18 +282,32 @@ int membership_list_add(MembershipList* list, ClubMembership membership) {
         return 0;
     }
     
-    if (list->count >= list->capacity) {
-        int new_capacity = list->capacity * 2;
-        ClubMembership* new_memberships = (ClubMembership*)realloc(list->memberships, sizeof(ClubMembership) * new_capacity);
-        if (new_memberships == NULL) {
-            printf("error: could not allocate more memory for memberships\n");
-            return 0;
+    // Reuse a tombstoned slot before growing
+    int slot = free_slots_pop(&list->free_slots);
+    while (slot >= 0 && (slot >= list->count || list->memberships[slot].id != TOMBSTONE_ID)) {
+        slot = free_slots_pop(&list->free_slots);
+    }
+    if (slot < 0) {
+        if (list->count >= list->capacity) {
+            int new_capacity = list->capacity * 2;
+            ClubMembership* new_memberships = (ClubMembership*)realloc(list->memberships, sizeof(ClubMembership) * new_capacity);
+            if (new_memberships == NULL) {
+                printf("error: could not allocate more memory for memberships\n");
+                return 0;
+            }
+            list->memberships = new_memberships;
+            list->capacity = new_capacity;
         }
-        list->memberships = new_memberships;
-        list->capacity = new_capacity;
+        slot = list->count++;
     }
     
-    list->memberships[list->count++] = membership;
+    list->memberships[slot] = membership;
+    if (!hash_index_insert(&list->id_index, utils_hash_int(membership.id), slot)) {
+        printf("error: could not index membership %d\n", membership.id);
+        list->memberships[slot].id = TOMBSTONE_ID;
+        free_slots_push(&list->free_slots, slot);
+        return 0;
+    }
     return 1;
 }
 
@@ -196,17 +317,43 @@ int membership_list_remove(MembershipList* list, int membership_id) {
         return 0;
     }
     
+    int i = membership_list_slot_of_id(list, membership_id);
+    if (i < 0) {
+        printf("error: membership with id %d not found\n", membership_id);
+        return 0;
+    }
+    // Tombstone instead of shifting the memberships behind it
+    hash_index_remove(&list->id_index, utils_hash_int(membership_id), i);
+    memset(&list->memberships[i], 0, sizeof(ClubMembership));
+    list->memberships[i].id = TOMBSTONE_ID;
+    if (!free_slots_push(&list->free_slots, i) ||
+        free_slots_should_compact(&list->free_slots, list->count)) {
+        membership_list_compact(list);
+    }
+    return 1;
+}
+
+// Squeeze out tombstones, keeping the remaining memberships in order
+void membership_list_compact(MembershipList* list) {
+    if (list == NULL || list->memberships == NULL) {
+        return;
+    }
+    int live = 0;
     for (int i = 0; i < list->count; i++) {
-        if (list->memberships[i].id == membership_id) {
-            for (int j = i; j < list->count - 1; j++) {
-                list->memberships[j] = list->memberships[j + 1];
-            }
-            list->count--;
-            return 1;
+        if (list->memberships[i].id == TOMBSTONE_ID) {
+            continue;
+        }
+        if (i != live) {
+            list->memberships[live] = list->memberships[i];
         }
+        live++;
+    }
+    int moved = live != list->count;
+    list->count = live;
+    free_slots_clear(&list->free_slots);
+    if (moved && !membership_list_rebuild_index(list)) {
+        printf("error: could not rebuild the membership index\n");
     }
-    printf("error: membership with id %d not found\n", membership_id);
-    return 0;
 }
 
 ClubMembership* membership_list_find_by_id(MembershipList* list, int membership_id) {
@@ -215,12 +362,8 @@ ClubMembership* membership_list_find_by_id(MembershipList* list, int membership_
         return NULL;
     }
     
-    for (int i = 0; i < list->count; i++) {
-        if (list->memberships[i].id == membership_id) {
-            return &list->memberships[i];
-        }
-    }
-    return NULL;
+    int slot = membership_list_slot_of_id(list, membership_id);
+    return slot >= 0 ? &list->memberships[slot] : NULL;
 }
 
 
@@ -242,6 +385,9 @@ int club_list_save_to_file(ClubList* list, const char* filename) {
     }
     for (int i = 0; i < list->count; i++) {
         Club* cb = &list->clubs[i];
+        if (cb->id == TOMBSTONE_ID) {
+            continue;
+        }
         // Save all fields in a CSV format
         fprintf(file, "%d,%s,%s,%s,%d,%d,%d,%d,%lld,%lld,%s,%s,%s,%f,%d\n",
             cb->id,
@@ -323,7 +469,12 @@ int club_list_load_from_file(ClubList* list, const char* filename){
         }
     }
     list->count = index;
+    free_slots_clear(&list->free_slots);
     fclose(file);
+    if (!club_list_rebuild_index(list)) {
+        printf("error: could not index the loaded clubs\n");
+        return 0;
+    }
     return 1;
 }
 int membership_list_save_to_file(MembershipList* list, const char* filename) {
@@ -338,6 +489,9 @@ int membership_list_save_to_file(MembershipList* list, const char* filename) {
     }
     for (int i = 0; i < list->count; i++) {
         ClubMembership* mmbsh = &list->memberships[i];
+        if (mmbsh->id == TOMBSTONE_ID) {
+            continue;
+        }
         // id,student_id,club_id,join_date,role,is_active
         fprintf(file, "%d,%d,%d,%lld,%s,%d\n",
             mmbsh->id,
@@ -399,7 +553,12 @@ int membership_list_load_from_file(MembershipList* list, const char* filename){
         }
     }
     list->count = index;
+    free_slots_clear(&list->free_slots);
     fclose(file);
+    if (!membership_list_rebuild_index(list)) {
+        printf("error: could not index the loaded memberships\n");
+        return 0;
+    }
     return 1;
 }
 
@@ -539,7 +698,8 @@ void club_display_summary(ClubList* list) {
         return;
     }
     
-    if (list->count == 0) {
+    int live = list->count - list->free_slots.count;
+    if (live == 0) {
         printf("No clubs available.\n");
         return;
     }
@@ -551,6 +711,9 @@ void club_display_summary(ClubList* list) {
     
     for (int i = 0; i < list->count; i++) {
         Club* club = &list->clubs[i];
+        if (club->id == TOMBSTONE_ID) {
+            continue;
+        }
         printf("%-5d %-30s %-20s %-8d %-8d %-10s\n",
                club->id,
                club->name,
@@ -561,7 +724,7 @@ void club_display_summary(ClubList* list) {
     }
     
     printf("----------------------------------------------------------------------------\n");
-    printf("Total clubs: %d\n\n", list->count);
+    printf("Total clubs: %d\n\n", live);
 }
 
 // Function for a student to join a club (creates a new membership)
@@ -0,0 +1,46 @@
+#include "free_slots.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+void free_slots_init(FreeSlots* free_slots) {
+    free_slots->slots = NULL;
+    free_slots->count = 0;
+    free_slots->capacity = 0;
+}
+
+void free_slots_free(FreeSlots* free_slots) {
+    free(free_slots->slots);
+    free_slots_init(free_slots);
+}
+
+void free_slots_clear(FreeSlots* free_slots) {
+    free_slots->count = 0;
+}
+
+int free_slots_push(FreeSlots* free_slots, int slot) {
+    if (free_slots->count >= free_slots->capacity) {
+        int capacity = free_slots->capacity > 0 ? free_slots->capacity * 2 : 16;
+        int* slots = (int*)realloc(free_slots->slots, sizeof(int) * capacity);
+        if (slots == NULL) {
+            printf("Error: Failed to allocate memory for free slots\n");
+            return 0;
+        }
+        free_slots->slots = slots;
+        free_slots->capacity = capacity;
+    }
+    free_slots->slots[free_slots->count++] = slot;
+    return 1;
+}
+
+// Most recently freed slot, or -1. The caller must check that the slot still
+// holds a tombstone: code that reorders records does not update this list.
+int free_slots_pop(FreeSlots* free_slots) {
+    if (free_slots->count == 0) {
+        return -1;
+    }
+    return free_slots->slots[--free_slots->count];
+}
+
+int free_slots_should_compact(const FreeSlots* free_slots, int slot_count) {
+    return free_slots->count >= FREE_SLOTS_COMPACT_MIN && free_slots->count * 2 > slot_count;
+}
@@ -8,10 +8,13 @@
 #include "auth.h"
 #include "attendance.h"
 #include "grade.h"
+#include "utils.h"
+#include "sort.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <stdint.h>
 #define MAX_NAME_LENGTH 100
 #define MAX_DESC_LENGTH 500
 typedef struct {
@@ -30,6 +33,8 @@ typedef struct {
     Module* cours;
     int count;
     int capacity;
+    FreeSlots free_slots;
+    HashIndex index; // id -> position in cours
     char filename[256];
 } ListeModules;
 typedef struct {
@@ -43,6 +48,7 @@ typedef struct {
     Examen* exam;
     int count;
     int capacity;
+    FreeSlots free_slots;
     char filename[256];
 }liste_examen;
 typedef struct {
@@ -55,6 +61,8 @@ typedef struct {
 Note *note;
 int count;
 int capacity;
+FreeSlots free_slots;
+HashIndex index; // (id_etudiant, id_examen) -> position in note
 char file_name[256];
 }liste_note;
 Examen* creer_examen() {
@@ -115,19 +123,32 @@ void afficher_examen(Examen *E) {
            E->duree);
 }
 int examen_ajouter(liste_examen* liste, Examen *ex){
+   // Reuse a tombstoned slot first
+   int slot=free_slots_pop(&liste->free_slots);
+   while(slot>=0 && (slot>=liste->count || liste->exam[slot].id_examen!=TOMBSTONE_ID))
+       slot=free_slots_pop(&liste->free_slots);
+   if(slot>=0){
+    liste->exam[slot]=*ex;
+    return(1);}
    if(liste->count<liste->capacity){
     (liste)->exam[liste->count++] =*ex;
     return(1);}
 
 return(0);
 }
+static void examen_enterrer(liste_examen* liste,int i){
+    // Tombstone instead of shifting the exams behind it
+    memset(&liste->exam[i],0,sizeof(Examen));
+    liste->exam[i].id_examen=TOMBSTONE_ID;
+    if(!free_slots_push(&liste->free_slots,i) ||
+       free_slots_should_compact(&liste->free_slots,liste->count))
+        liste_examen_compacter(liste);
+}
 int examen_supprimer_par_id(liste_examen* liste,int id_examen){
 if(liste->count!=0){
         for(int i=0;i<liste->count;i++){
             if((liste)->exam[i].id_examen==id_examen){
-                 for(int j=i;j<liste->count-1;j++)
-                   (liste)->exam[j]=(liste)->exam[j+1];
-                   liste->count--;
+                 examen_enterrer(liste,i);
                  return(1);
             }
         }
@@ -139,10 +160,8 @@ return(0);
 int examen_supprimer_par_nom(liste_examen* liste,char* nom_examen){
 if(liste->count!=0){
         for(int i=0;i<liste->count;i++){
-            if(strcmp((liste)->exam[i].nom_module,nom_examen)==0){
-                 for(int j=i;j<liste->count-1;j++)
-                   (liste)->exam[j]=(liste)->exam[j+1];
-                   liste->count--;
+            if(liste->exam[i].id_examen!=TOMBSTONE_ID && strcmp((liste)->exam[i].nom_module,nom_examen)==0){
+                 examen_enterrer(liste,i);
                  return(1);
             }
         }
@@ -151,6 +170,19 @@ if(liste->count!=0){
 
 return(0);
 }
+// Squeeze out tombstones, keeping the remaining exams in order
+void liste_examen_compacter(liste_examen* liste){
+    if(liste==NULL || liste->exam==NULL) return;
+    int vivants=0;
+    for(int i=0;i<liste->count;i++){
+        if(liste->exam[i].id_examen==TOMBSTONE_ID) continue;
+        if(i!=vivants)
+            liste->exam[vivants]=liste->exam[i];
+        vivants++;
+    }
+    liste->count=vivants;
+    free_slots_clear(&liste->free_slots);
+}
 
 void afficher_liste_examens(liste_examen *liste) {
     if (liste == NULL || liste->exam == NULL) {
@@ -158,7 +190,7 @@ void afficher_liste_examens(liste_examen *liste) {
         return;
     }
 
-    if (liste->count == 0) {
+    if (liste->count - liste->free_slots.count == 0) {
         printf("No exams to display.\n");
         return;
     }
@@ -167,6 +199,7 @@ void afficher_liste_examens(liste_examen *liste) {
     printf("+-----------+-----------+-------------------------+------------+----------+-------------+----------+\n");
 
     for (int i = 0; i < liste->count; i++) {
+        if (liste->exam[i].id_examen == TOMBSTONE_ID) continue;
             printf("+-----+-------------------------+----------+----------+----------+-----+-----------------------------+-----------+-----------+\n");
         Examen * E = &liste->exam[i];
         struct tm *info = localtime(&E->date_examen);
@@ -189,6 +222,7 @@ liste_examen* cree_liste_examen(){
     liste_examen * liste=(liste_examen*)malloc(sizeof(liste_examen));
     liste->capacity=3000;
     liste->count=0;
+    free_slots_init(&liste->free_slots);
     liste->exam=(Examen*)malloc(liste->capacity*sizeof(Examen));
     strcpy(liste->filename,"liste_des_examen.txt");
     return(liste);
@@ -202,7 +236,7 @@ return(NULL);
 }
 Examen* chercher_examen_par_nom(liste_examen* liste,char* nom){
 for(int i=0;i<liste->count;i++){
-    if(strcmp(liste->exam[i].nom_module,nom)==0)
+    if(liste->exam[i].id_examen!=TOMBSTONE_ID && strcmp(liste->exam[i].nom_module,nom)==0)
         return(&liste->exam[i]);
 }
 return(NULL);
@@ -259,9 +293,10 @@ void modidier_examen(liste_examen liste){
     }
 }
 int sauvegarder_liste_examen_ds_file(liste_examen *liste){
-    if(liste->count==0) return(0);
+    if(liste->count-liste->free_slots.count==0) return(0);
 FILE *p=fopen(liste->filename,"w");
 for(int i=0;i<liste->count;i++){
+    if(liste->exam[i].id_examen==TOMBSTONE_ID) continue;
         struct tm *info = localtime(&liste->exam[i].date_examen);
     fprintf(p,"| %d | %d | %s | %d/%d/%d | %d:%d:%d | %d |",
            liste->exam[i].id_examen,
@@ -307,69 +342,98 @@ while(i<liste->capacity){
            i++;
 }
 liste->count=i;
+free_slots_clear(&liste->free_slots);
 fclose(p);
 return(1);
 }
-int trie_liste_examen_id(liste_examen liste ,int n ){
-if(n==1){
-    for(int i=0;i<liste.count;i++){
-            Examen min=liste.exam[i];
-        for(int j=1+i;j<liste.count;j++){
-            if(liste.exam[j].id_examen<min.id_examen){
-                      Examen h=liste.exam[j];
-               liste.exam[j]=min;
-            min=h;
-            }
-        }liste.exam[i]=min;
+// Stable order of count positions, by integer sort keys when cles is given
+// (radix, linear time) or else by comparer (merge sort); NULL on failure
+static int* grade_ordre(int count, const unsigned int *cles, SortCompareFunc comparer, const void *contexte) {
+    int *ordre = (int*)malloc(count * sizeof(int));
+    if (ordre == NULL) {
+        printf("Error: memory allocation failed!\n");
+        return NULL;
     }
-    return(1);
-}
-else{
-     for(int i=0;i<liste.count;i++){
-            Examen max=liste.exam[i];
-        for(int j=1+i;j<liste.count;j++){
-            if(liste.exam[j].id_examen>max.id_examen){
-                  Examen h=liste.exam[j];
-               liste.exam[j]=max;
-            max=h;
-            }
-        }liste.exam[i]=max;
+    sort_identity(ordre, count);
+    int ok = cles != NULL ? sort_radix_indices(cles, ordre, count)
+                          : sort_merge_indices(ordre, count, comparer, contexte);
+    if (!ok) {
+        free(ordre);
+        return NULL;
     }
-    return(1);
-}
-return(0);
-
-
-}
-int trie_liste_examen_nom(int n,liste_examen liste){
-    if(n==1){
-    for(int i=0;i<liste.count;i++){
-             Examen min=liste.exam[i];
-        for(int j=1+i;j<liste.count;j++){
-            if(strcmp(liste.exam[j].nom_module,min.nom_module)>0){
-                       Examen h=liste.exam[j];
-               liste.exam[j]=min;
-            min=h;
-            }
-        }liste.exam[i]=min;
+    return ordre;
+}
+static int examen_comparer_noms(int a, int b, const void *contexte) {
+    const liste_examen *liste = (const liste_examen*)contexte;
+    return strcmp(liste->exam[a].nom_module, liste->exam[b].nom_module);
+}
+static int examen_comparer_noms_inverse(int a, int b, const void *contexte) {
+    return examen_comparer_noms(b, a, contexte);
+}
+// Rearrange the exams of the caller's list in the given order
+static int examen_ranger(liste_examen *liste, int *ordre) {
+    if (ordre == NULL) return 0;
+    int ok = sort_apply_permutation(liste->exam, sizeof(Examen), ordre, liste->count);
+    free(ordre);
+    return ok;
+}
+// n == 1: ascending ids, otherwise descending; equal ids keep their order
+int trie_liste_examen_id(liste_examen *liste ,int n ){
+    liste_examen_compacter(liste);
+    if (liste == NULL) return 0;
+    if (liste->count < 2) return 1;
+
+    unsigned int *cles = (unsigned int*)malloc(liste->count * sizeof(unsigned int));
+    if (cles == NULL) return 0;
+    for (int i = 0; i < liste->count; i++) {
+        cles[i] = sort_key_from_int(liste->exam[i].id_examen);
+        if (n != 1) cles[i] = ~cles[i];
     }
-    return(1);
-}
-else{
-     for(int i=0;i<liste.count;i++){
-             Examen max=liste.exam[i];
-        for(int j=1+i;j<liste.count;j++){
-            if(strcmp(liste.exam[j].nom_module,max.nom_module)<0){
-                  Examen h=liste.exam[j];
-               liste.exam[j]=max;
-            max=h;
-            }
-        }liste.exam[i]=max;
+    int *ordre = grade_ordre(liste->count, cles, NULL, NULL);
+    free(cles);
+    return examen_ranger(liste, ordre);
+}
+// n == 1: names from Z to A, otherwise from A to Z
+int trie_liste_examen_nom(int n,liste_examen *liste){
+    liste_examen_compacter(liste);
+    if (liste == NULL) return 0;
+    if (liste->count < 2) return 1;
+
+    return examen_ranger(liste, grade_ordre(liste->count, NULL,
+                         n == 1 ? examen_comparer_noms_inverse : examen_comparer_noms, liste));
+}
+static unsigned long note_cle(int id_etudiant, int id_examen) {
+    return utils_hash_combine(utils_hash_int(id_etudiant), utils_hash_int(id_examen));
+}
+
+// Position of the first grade of the student for the exam, or -1
+static int note_position(liste_note *liste, int id_etudiant, int id_examen) {
+    int trouve = -1;
+    HashIndexProbe probe;
+    int slot;
+    hash_index_probe_begin(&liste->index, note_cle(id_etudiant, id_examen), &probe);
+    while ((slot = hash_index_probe_next(&probe)) >= 0) {
+        if (slot < liste->count && (trouve < 0 || slot < trouve) &&
+            liste->note[slot].id_etudiant == id_etudiant &&
+            liste->note[slot].id_examen == id_examen) {
+            trouve = slot;
+        }
     }
-    return(1);
+    return trouve;
 }
-return(0);
+
+// Rebuild the index after grades have been moved or reloaded
+static int liste_note_reindexer(liste_note *liste) {
+    hash_index_clear(&liste->index);
+    if (!hash_index_reserve(&liste->index, liste->count)) return 0;
+    for (int i = 0; i < liste->count; i++) {
+        if (liste->note[i].id_etudiant == TOMBSTONE_ID) continue;
+        if (!hash_index_insert(&liste->index, note_cle(liste->note[i].id_etudiant, liste->note[i].id_examen), i))
+            return 0;
+    }
+    return 1;
 }
+
 liste_note* creer_liste_note(int capacite) {
     liste_note *liste = (liste_note*)malloc(sizeof(liste_note));
     if (liste == NULL) {
@@ -385,6 +449,8 @@ liste_note* creer_liste_note(int capacite) {
 
     liste->count = 0;
     liste->capacity = capacite;
+    free_slots_init(&liste->free_slots);
+    hash_index_init(&liste->index);
     strcpy(liste->file_name, "liste_des_notes.txt");
 
     return liste;
@@ -419,20 +485,114 @@ Note* cree_note() {
     return n;
 }
 
+// Checks shared by single and batch inserts: a real student and exam, a
+// grade out of 20
+static int note_acceptable(const Note *n) {
+    if (n->id_etudiant == TOMBSTONE_ID || n->id_examen == TOMBSTONE_ID) {
+        printf("Invalid student or exam id (%d, %d)\n", n->id_etudiant, n->id_examen);
+        return 0;
+    }
+    if (n->note_obtenue < 0 || n->note_obtenue > 20) {
+        printf(" Grade must be between 0 and 20!\n");
+        return 0;
+    }
+    return 1;
+}
+
+// Takes ownership of n, which is freed whether or not it was added
 int note_ajouter(liste_note *liste, Note *n) {
-    if (liste == NULL || n == NULL) return 0;
+    if (n == NULL) return 0;
+    if (liste == NULL || !note_acceptable(n)) {
+        free(n);
+        return 0;
+    }
+
+    // One grade per student and exam
+    if (note_position(liste, n->id_etudiant, n->id_examen) >= 0) {
+        printf("Student %d already has a grade for exam %d\n", n->id_etudiant, n->id_examen);
+        free(n);
+        return 0;
+    }
+
+    // Reuse a tombstoned slot before growing
+    int slot = free_slots_pop(&liste->free_slots);
+    while (slot >= 0 && (slot >= liste->count || liste->note[slot].id_etudiant != TOMBSTONE_ID)) {
+        slot = free_slots_pop(&liste->free_slots);
+    }
+    if (slot >= 0) {
+        if (!hash_index_insert(&liste->index, note_cle(n->id_etudiant, n->id_examen), slot)) {
+            free_slots_push(&liste->free_slots, slot);
+            free(n);
+            return 0;
+        }
+        liste->note[slot] = *n;
+        free(n);
+        return 1;
+    }
 
     if (liste->count >= liste->capacity) {
+        Note *agrandi = (Note*)realloc(liste->note,
+                                       liste->capacity * 2 * sizeof(Note));
+        if (agrandi == NULL) {
+            free(n);
+            return 0;
+        }
+        liste->note = agrandi;
         liste->capacity *= 2;
-        liste->note = (Note*)realloc(liste->note,
-                                     liste->capacity * sizeof(Note));
-        if (liste->note == NULL) return 0;
     }
 
+    if (!hash_index_insert(&liste->index, note_cle(n->id_etudiant, n->id_examen), liste->count)) {
+        free(n);
+        return 0;
+    }
     liste->note[liste->count++] = *n;
     free(n);
     return 1;
 }
+// Append n grades in one go: validated first, then one realloc and one copy.
+// Unlike note_ajouter the caller keeps ownership of the array.
+int note_ajouter_plusieurs(liste_note *liste, const Note *notes, int n) {
+    if (liste == NULL || n < 0 || (notes == NULL && n > 0)) return 0;
+
+    for (int i = 0; i < n; i++) {
+        if (!note_acceptable(&notes[i])) {
+            printf("Invalid grade at position %d, nothing added\n", i);
+            return 0;
+        }
+        if (note_position(liste, notes[i].id_etudiant, notes[i].id_examen) >= 0) {
+            printf("Grade at position %d already exists, nothing added\n", i);
+            return 0;
+        }
+    }
+
+    if (liste->count + n > liste->capacity) {
+        int capacite = liste->capacity * 2;
+        if (capacite < liste->count + n) capacite = liste->count + n;
+        Note *agrandi = (Note*)realloc(liste->note, capacite * sizeof(Note));
+        if (agrandi == NULL) return 0;
+        liste->note = agrandi;
+        liste->capacity = capacite;
+    }
+    if (!hash_index_reserve(&liste->index, liste->count + n)) return 0;
+
+    // Index as we copy so a pair repeated within the batch is caught too;
+    // on failure the entries already added are taken back out
+    int debut = liste->count;
+    memcpy(&liste->note[debut], notes, n * sizeof(Note));
+    for (int i = 0; i < n; i++) {
+        liste->count = debut + i + 1;
+        int doublon = note_position(liste, notes[i].id_etudiant, notes[i].id_examen) >= 0;
+        if (doublon || !hash_index_insert(&liste->index, note_cle(notes[i].id_etudiant, notes[i].id_examen), debut + i)) {
+            if (doublon) printf("Grade at position %d repeats an earlier one, nothing added\n", i);
+            for (int j = 0; j < i; j++) {
+                hash_index_remove(&liste->index, note_cle(notes[j].id_etudiant, notes[j].id_examen), debut + j);
+            }
+            liste->count = debut;
+            return 0;
+        }
+    }
+    return n;
+}
 
 void afficher_note(Note *n) {
     if (n == NULL) {
@@ -453,7 +613,8 @@ void afficher_liste_notes(liste_note *liste) {
         return;
     }
 
-    if (liste->count == 0) {
+    int vivantes = liste->count - liste->free_slots.count;
+    if (vivantes == 0) {
         printf("\nNo grades to display.\n");
         return;
     }
@@ -463,23 +624,19 @@ void afficher_liste_notes(liste_note *liste) {
     printf("+--------------+------------+--------------+----------+\n");
 
     for (int i = 0; i < liste->count; i++) {
+        if (liste->note[i].id_etudiant == TOMBSTONE_ID) continue;
         afficher_note(&liste->note[i]);
     }
 
     printf("+--------------+------------+--------------+----------+\n");
-    printf("Total: %d note(s)\n\n", liste->count);
+    printf("Total: %d note(s)\n\n", vivantes);
 }
 
 Note* chercher_note(liste_note *liste, int id_etudiant, int id_examen) {
     if (liste == NULL) return NULL;
 
-    for (int i = 0; i < liste->count; i++) {
-        if (liste->note[i].id_etudiant == id_etudiant &&
-            liste->note[i].id_examen == id_examen) {
-            return &liste->note[i];
-        }
-    }
-    return NULL;
+    int i = note_position(liste, id_etudiant, id_examen);
+    return i >= 0 ? &liste->note[i] : NULL;
 }
 
 void afficher_notes_etudiant(liste_note *liste, int id_etudiant) {
@@ -600,18 +757,38 @@ void modifier_note(liste_note *liste) {
 int note_supprimer(liste_note *liste, int id_etudiant, int id_examen) {
     if (liste == NULL || liste->count == 0) return 0;
 
-    for (int i = 0; i < liste->count; i++) {
-        if (liste->note[i].id_etudiant == id_etudiant &&
-            liste->note[i].id_examen == id_examen) {
+    int i = note_position(liste, id_etudiant, id_examen);
+    if (i < 0) return 0;
+
+    // Tombstone both ids so no lookup by student or exam matches it
+    hash_index_remove(&liste->index, note_cle(id_etudiant, id_examen), i);
+    memset(&liste->note[i], 0, sizeof(Note));
+    liste->note[i].id_etudiant = TOMBSTONE_ID;
+    liste->note[i].id_examen = TOMBSTONE_ID;
+    if (!free_slots_push(&liste->free_slots, i) ||
+        free_slots_should_compact(&liste->free_slots, liste->count)) {
+        liste_note_compacter(liste);
+    }
+    return 1;
+}
+// Squeeze out tombstones, keeping the remaining grades in order
+void liste_note_compacter(liste_note *liste) {
+    if (liste == NULL || liste->note == NULL) return;
 
-            for (int j = i; j < liste->count - 1; j++) {
-                liste->note[j] = liste->note[j + 1];
-            }
-            liste->count--;
-            return 1;
+    int vivants = 0;
+    for (int i = 0; i < liste->count; i++) {
+        if (liste->note[i].id_etudiant == TOMBSTONE_ID) continue;
+        if (i != vivants) {
+            liste->note[vivants] = liste->note[i];
         }
+        vivants++;
+    }
+    int deplaces = vivants != liste->count;
+    liste->count = vivants;
+    free_slots_clear(&liste->free_slots);
+    if (deplaces && !liste_note_reindexer(liste)) {
+        printf("Error: failed to rebuild the grade index\n");
     }
-    return 0;
 }
 float calculer_moyenne_etudiant(liste_note *liste, int id_etudiant) {
     if (liste == NULL || liste->count == 0) return -1;
@@ -693,7 +870,7 @@ void statistiques_examen(liste_note *liste, int id_examen) {
     printf("==========================================\n\n");
 }
 int sauvegarder_notes_ds_file(liste_note *liste) {
-    if (liste == NULL || liste->count == 0) return 0;
+    if (liste == NULL || liste->count - liste->free_slots.count == 0) return 0;
 
     FILE *p = fopen(liste->file_name, "w");
     if (p == NULL) {
@@ -701,7 +878,10 @@ int sauvegarder_notes_ds_file(liste_note *liste) {
         return 0;
     }
 
+    int ecrites = 0;
     for (int i = 0; i < liste->count; i++) {
+        if (liste->note[i].id_etudiant == TOMBSTONE_ID) continue;
+        ecrites++;
         fprintf(p, "%d,%d,%.2f,%d\n",
                 liste->note[i].id_etudiant,
                 liste->note[i].id_examen,
@@ -710,53 +890,505 @@ int sauvegarder_notes_ds_file(liste_note *liste) {
     }
 
     fclose(p);
-    printf(" %d note(s) sauvegardee(s)\n", liste->count);
+    printf(" %d note(s) sauvegardee(s)\n", ecrites);
+    return 1;
+}
+static void note_ecrire_u32(unsigned char *p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+static uint32_t note_lire_u32(const unsigned char *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void note_encoder(unsigned char *p, const Note *n) {
+    uint32_t bits;
+    memcpy(&bits, &n->note_obtenue, sizeof(bits));
+    note_ecrire_u32(p, (uint32_t)n->id_etudiant);
+    note_ecrire_u32(p + 4, (uint32_t)n->id_examen);
+    note_ecrire_u32(p + 8, bits);
+    note_ecrire_u32(p + 12, (uint32_t)n->present);
+}
+
+static void note_decoder(Note *n, const unsigned char *p) {
+    uint32_t bits = note_lire_u32(p + 8);
+    n->id_etudiant = (int)note_lire_u32(p);
+    n->id_examen = (int)note_lire_u32(p + 4);
+    memcpy(&n->note_obtenue, &bits, sizeof(bits));
+    n->present = (int)note_lire_u32(p + 12);
+}
+
+// Same grades as sauvegarder_notes_ds_file, but every float kept bit for bit.
+// Written to chemin, or NOTES_FICHIER_BINAIRE if it is NULL, so the text
+// file in file_name is left alone.
+int sauvegarder_notes_binaire(liste_note *liste, const char *chemin) {
+    if (liste == NULL) return 0;
+    if (chemin == NULL) chemin = NOTES_FICHIER_BINAIRE;
+    int vivantes = 0;
+    for (int i = 0; i < liste->count; i++) {
+        if (liste->note[i].id_etudiant != TOMBSTONE_ID) vivantes++;
+    }
+
+    FILE *p = fopen(chemin, "wb");
+    if (p == NULL) {
+        printf("Error opening file!\n");
+        return 0;
+    }
+
+    unsigned char entete[NOTES_FICHIER_ENTETE];
+    memset(entete, 0, sizeof(entete));
+    memcpy(entete, NOTES_FICHIER_MAGIC, sizeof(NOTES_FICHIER_MAGIC));
+    note_ecrire_u32(entete + 8, NOTES_FICHIER_VERSION);
+    note_ecrire_u32(entete + 12, (uint32_t)vivantes);
+    int ok = fwrite(entete, sizeof(entete), 1, p) == 1;
+
+    unsigned char bloc[NOTES_FICHIER_BLOC * NOTES_FICHIER_ENREGISTREMENT];
+    uint32_t somme = 1;
+    for (int i = 0; ok && i < liste->count; ) {
+        // Tombstones are left out, so a block may span more slots than it holds
+        int n = 0;
+        for (; i < liste->count && n < NOTES_FICHIER_BLOC; i++) {
+            if (liste->note[i].id_etudiant == TOMBSTONE_ID) continue;
+            note_encoder(bloc + (size_t)n * NOTES_FICHIER_ENREGISTREMENT, &liste->note[i]);
+            n++;
+        }
+        if (n == 0) break;
+        size_t taille = (size_t)n * NOTES_FICHIER_ENREGISTREMENT;
+        somme = utils_hash_adler32(somme, bloc, taille);
+        ok = fwrite(bloc, 1, taille, p) == taille;
+    }
+    if (ok) {
+        unsigned char fin[4];
+        note_ecrire_u32(fin, somme);
+        ok = fwrite(fin, sizeof(fin), 1, p) == 1;
+    }
+    if (fclose(p) != 0) ok = 0;
+    if (!ok) {
+        printf("Error writing %s\n", chemin);
+        remove(chemin);
+        return 0;
+    }
+    printf(" %d note(s) sauvegardee(s)\n", vivantes);
+    return 1;
+}
+
+// Make room for at least capacite grades
+static int liste_note_reserver(liste_note *liste, int capacite) {
+    if (capacite <= liste->capacity) return 1;
+    Note *agrandi = (Note*)realloc(liste->note, (size_t)capacite * sizeof(Note));
+    if (agrandi == NULL) {
+        printf("Error: memory allocation failed!\n");
+        return 0;
+    }
+    liste->note = agrandi;
+    liste->capacity = capacite;
+    return 1;
+}
+
+static void note_sauter_blancs(const char **p, const char *fin) {
+    while (*p < fin && (**p == ' ' || **p == '\t')) (*p)++;
+}
+
+static int note_lire_virgule(const char **p, const char *fin) {
+    note_sauter_blancs(p, fin);
+    if (*p >= fin || **p != ',') return 0;
+    (*p)++;
+    return 1;
+}
+
+static int note_lire_entier(const char **p, const char *fin, int *valeur) {
+    note_sauter_blancs(p, fin);
+    const char *q = *p;
+    int negatif = q < fin && *q == '-';
+    if (q < fin && (*q == '-' || *q == '+')) q++;
+    if (q >= fin || *q < '0' || *q > '9') return 0;
+    long long v = 0;
+    while (q < fin && *q >= '0' && *q <= '9') {
+        v = v * 10 + (*q++ - '0');
+        if (v > 2147483648LL) return 0;
+    }
+    if (negatif) v = -v;
+    if (v > 2147483647LL) return 0;
+    *valeur = (int)v;
+    *p = q;
+    return 1;
+}
+
+// Plain decimals of up to 7 digits, which covers grades written with %.2f,
+// are converted from an integer mantissa: both it and the power of ten fit
+// a float exactly, so one division in double rounds to the same float
+// strtof gives. Anything longer or with an exponent goes through strtof.
+#define NOTE_CHIFFRES_RAPIDES 7
+static int note_lire_reel(const char **p, const char *fin, float *valeur) {
+    static const double puissances[NOTE_CHIFFRES_RAPIDES + 1] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7
+    };
+    note_sauter_blancs(p, fin);
+    const char *debut = *p;
+    const char *q = debut;
+    int negatif = q < fin && *q == '-';
+    if (q < fin && (*q == '-' || *q == '+')) q++;
+    unsigned long long mantisse = 0;
+    int chiffres = 0;
+    int decimales = 0;
+    while (q < fin && *q >= '0' && *q <= '9') {
+        mantisse = mantisse * 10 + (unsigned long long)(*q++ - '0');
+        chiffres++;
+    }
+    if (q < fin && *q == '.') {
+        q++;
+        while (q < fin && *q >= '0' && *q <= '9') {
+            mantisse = mantisse * 10 + (unsigned long long)(*q++ - '0');
+            chiffres++;
+            decimales++;
+        }
+    }
+    if (chiffres == 0) return 0;
+
+    if (chiffres > NOTE_CHIFFRES_RAPIDES || (q < fin && (*q == 'e' || *q == 'E'))) {
+        char tampon[64];
+        const char *champ = debut;
+        while (champ < fin && *champ != ',' && *champ != '\r' && *champ != '\n') champ++;
+        size_t longueur = (size_t)(champ - debut);
+        if (longueur >= sizeof(tampon)) return 0;
+        memcpy(tampon, debut, longueur);
+        tampon[longueur] = '\0';
+        char *arret;
+        *valeur = strtof(tampon, &arret);
+        if (arret == tampon) return 0;
+        *p = debut + (arret - tampon);
+        return 1;
+    }
+
+    double v = (double)mantisse / puissances[decimales];
+    *valeur = (float)(negatif ? -v : v);
+    *p = q;
+    return 1;
+}
+
+// One "id_etudiant,id_examen,note,present" line, spaces allowed around fields
+static int note_lire_ligne(const char *p, const char *fin, Note *n) {
+    if (!note_lire_entier(&p, fin, &n->id_etudiant) || !note_lire_virgule(&p, fin) ||
+        !note_lire_entier(&p, fin, &n->id_examen) || !note_lire_virgule(&p, fin) ||
+        !note_lire_reel(&p, fin, &n->note_obtenue) || !note_lire_virgule(&p, fin) ||
+        !note_lire_entier(&p, fin, &n->present)) {
+        return 0;
+    }
+    note_sauter_blancs(&p, fin);
+    if (p < fin && *p == '\r') p++;
+    return p == fin;
+}
+
+static int charger_notes_texte(liste_note *liste, const char *donnees, size_t taille) {
+    const char *p = donnees;
+    const char *fin = donnees + taille;
+    int ligne = 0;
+    liste->count = 0;
+    while (p < fin) {
+        const char *fin_ligne = (const char*)memchr(p, '\n', (size_t)(fin - p));
+        if (fin_ligne == NULL) fin_ligne = fin;
+        ligne++;
+
+        const char *q = p;
+        note_sauter_blancs(&q, fin_ligne);
+        int vide = q == fin_ligne || (*q == '\r' && q + 1 == fin_ligne);
+        if (!vide) {
+            Note n;
+            if (!note_lire_ligne(p, fin_ligne, &n)) {
+                printf("Error: line %d of %s is malformed, loading stopped after %d grade(s)\n",
+                       ligne, liste->file_name, liste->count);
+                return 0;
+            }
+            if (liste->count >= liste->capacity &&
+                !liste_note_reserver(liste, liste->capacity > 0 ? liste->capacity * 2 : 64)) {
+                printf("Error: loading stopped at line %d of %s\n", ligne, liste->file_name);
+                return 0;
+            }
+            liste->note[liste->count++] = n;
+        }
+        p = fin_ligne + 1;
+    }
     return 1;
 }
+
+static int charger_notes_binaire(liste_note *liste, const unsigned char *donnees, size_t taille) {
+    liste->count = 0;
+    if (taille < NOTES_FICHIER_ENTETE + 4 || note_lire_u32(donnees + 8) != NOTES_FICHIER_VERSION) {
+        printf("Error: %s is not a grade file this version can read\n", liste->file_name);
+        return 0;
+    }
+    uint32_t count = note_lire_u32(donnees + 12);
+    size_t enregistrements = taille - NOTES_FICHIER_ENTETE - 4;
+    if (count > (uint32_t)INT_MAX || enregistrements / NOTES_FICHIER_ENREGISTREMENT != count ||
+        enregistrements % NOTES_FICHIER_ENREGISTREMENT != 0) {
+        printf("Error: %s is truncated or damaged\n", liste->file_name);
+        return 0;
+    }
+    const unsigned char *debut = donnees + NOTES_FICHIER_ENTETE;
+    if (utils_hash_adler32(1, debut, enregistrements) != note_lire_u32(debut + enregistrements)) {
+        printf("Error: %s failed its checksum\n", liste->file_name);
+        return 0;
+    }
+    if (!liste_note_reserver(liste, (int)count)) return 0;
+    for (uint32_t i = 0; i < count; i++) {
+        note_decoder(&liste->note[i], debut + (size_t)i * NOTES_FICHIER_ENREGISTREMENT);
+    }
+    liste->count = (int)count;
+    return 1;
+}
+
+// Replace the grades with those of the file, text or binary, growing the
+// list as needed. Text is parsed straight off the mapped file; a malformed
+// line stops the load, keeps the grades read before it and returns 0.
 int charger_notes_depuis_file(liste_note *liste) {
     if (liste == NULL || liste->note == NULL) return 0;
-    FILE *p = fopen(liste->file_name, "r");
-    if (p == NULL) {
+
+    UtilsMappedFile fichier;
+    if (!utils_file_map(liste->file_name, &fichier)) {
         printf("Error opening file!\n");
         return 0;
     }
-int i=0;
-   while(i<liste->capacity){
-        int n=fscanf(p, "%d,%d,%f,%d",
-                           &liste->note[i].id_etudiant,
-                           &liste->note[i].id_examen,
-                           &liste->note[i].note_obtenue,
-                           &liste->note[i].present);
-        if(n!=4) break;
-        i++;
-   }
-  liste->count=i;
-    fclose(p);
+    int ok;
+    if (fichier.size >= sizeof(NOTES_FICHIER_MAGIC) &&
+        memcmp(fichier.data, NOTES_FICHIER_MAGIC, sizeof(NOTES_FICHIER_MAGIC)) == 0) {
+        ok = charger_notes_binaire(liste, (const unsigned char*)fichier.data, fichier.size);
+    } else {
+        ok = charger_notes_texte(liste, fichier.data, fichier.size);
+    }
+    utils_file_unmap(&fichier);
+
+    free_slots_clear(&liste->free_slots);
+    if (!liste_note_reindexer(liste)) {
+        printf("Error: failed to rebuild the grade index\n");
+        return 0;
+    }
     printf(" %d grade(s) loaded\n", liste->count);
-    return 1;
+    return ok;
 }
 
+// Stable and linear: a radix sort of positions, then each grade moved once
 void trier_notes_par_etudiant(liste_note *liste) {
+    liste_note_compacter(liste);
     if (liste == NULL || liste->count <= 1) return;
 
-    for (int i = 0; i < liste->count - 1; i++) {
-        for (int j = i + 1; j < liste->count; j++) {
-            if (liste->note[j].id_etudiant < liste->note[i].id_etudiant) {
-                Note temp = liste->note[i];
-                liste->note[i] = liste->note[j];
-                liste->note[j] = temp;
-            }
-        }
+    unsigned int *cles = (unsigned int*)malloc(liste->count * sizeof(unsigned int));
+    if (cles == NULL) {
+        printf("Error: memory allocation failed!\n");
+        return;
+    }
+    for (int i = 0; i < liste->count; i++) {
+        cles[i] = sort_key_from_int(liste->note[i].id_etudiant);
+    }
+    int *ordre = grade_ordre(liste->count, cles, NULL, NULL);
+    free(cles);
+    if (ordre == NULL) return;
+    sort_apply_permutation(liste->note, sizeof(Note), ordre, liste->count);
+    free(ordre);
+
+    if (!liste_note_reindexer(liste)) {
+        printf("Error: failed to rebuild the grade index\n");
     }
     printf("List sorted by student ID\n");
 }
 
 
+void note_groupes_init(NoteGroupes *groupes) {
+    groupes->groupes = NULL;
+    groupes->count = 0;
+    groupes->capacity = 0;
+    hash_index_init(&groupes->index);
+}
+
+void note_groupes_liberer(NoteGroupes *groupes) {
+    if (groupes == NULL) return;
+    free(groupes->groupes);
+    hash_index_free(&groupes->index);
+    note_groupes_init(groupes);
+}
+
+NoteAgregat* note_groupes_chercher(NoteGroupes *groupes, int id) {
+    if (groupes == NULL) return NULL;
+
+    HashIndexProbe probe;
+    int i;
+    hash_index_probe_begin(&groupes->index, utils_hash_int(id), &probe);
+    while ((i = hash_index_probe_next(&probe)) >= 0) {
+        if (groupes->groupes[i].id == id) return &groupes->groupes[i];
+    }
+    return NULL;
+}
+
+// Aggregate of id, added empty if it is not there yet
+static NoteAgregat* note_groupes_entree(NoteGroupes *groupes, int id) {
+    NoteAgregat *a = note_groupes_chercher(groupes, id);
+    if (a != NULL) return a;
+
+    if (groupes->count >= groupes->capacity) {
+        int capacite = groupes->capacity > 0 ? groupes->capacity * 2 : 64;
+        NoteAgregat *agrandi = (NoteAgregat*)realloc(groupes->groupes, capacite * sizeof(NoteAgregat));
+        if (agrandi == NULL) return NULL;
+        groupes->groupes = agrandi;
+        groupes->capacity = capacite;
+    }
+    if (!hash_index_insert(&groupes->index, utils_hash_int(id), groupes->count)) return NULL;
+
+    a = &groupes->groupes[groupes->count++];
+    memset(a, 0, sizeof(NoteAgregat));
+    a->id = id;
+    a->min = 20;
+    a->max = 0;
+    return a;
+}
+
+static void note_agregat_ajouter(NoteAgregat *a, const Note *n) {
+    if (n->present != 1) {
+        a->absents++;
+        return;
+    }
+    a->presents++;
+    a->somme += n->note_obtenue;
+    if (n->note_obtenue < a->min) a->min = n->note_obtenue;
+    if (n->note_obtenue > a->max) a->max = n->note_obtenue;
+    if (n->note_obtenue >= 10) a->admis++;
+}
+
+// Totals for every student and every exam in a single pass over the grades.
+// Either output may be NULL; both are emptied first. Returns 1, or 0 if out
+// of memory.
+int note_grouper(liste_note *liste, NoteGroupes *par_etudiant, NoteGroupes *par_examen) {
+    if (liste == NULL) return 0;
+    if (par_etudiant != NULL) {
+        note_groupes_liberer(par_etudiant);
+    }
+    if (par_examen != NULL) {
+        note_groupes_liberer(par_examen);
+    }
+
+    for (int i = 0; i < liste->count; i++) {
+        const Note *n = &liste->note[i];
+        if (n->id_etudiant == TOMBSTONE_ID) continue;
+
+        if (par_etudiant != NULL) {
+            NoteAgregat *a = note_groupes_entree(par_etudiant, n->id_etudiant);
+            if (a == NULL) return 0;
+            note_agregat_ajouter(a, n);
+        }
+        if (par_examen != NULL) {
+            NoteAgregat *a = note_groupes_entree(par_examen, n->id_examen);
+            if (a == NULL) return 0;
+            note_agregat_ajouter(a, n);
+        }
+    }
+    return 1;
+}
+
+// Same value as calculer_moyenne_etudiant/examen for the id: -1 without
+// any grade from a student present
+float note_agregat_moyenne(const NoteAgregat *agregat) {
+    if (agregat == NULL || agregat->presents == 0) return -1;
+    return (float)(agregat->somme / agregat->presents);
+}
+
+// Fill meilleurs with the ids of the k best keys, best first, and derniers
+// with the k worst, worst first; either may be NULL. Returns how many ids
+// each got, or -1 if out of memory.
+static int note_classer(const int *ids, const unsigned int *cles, int n, int k, int *meilleurs, int *derniers) {
+    if (k <= 0 || n <= 0) return 0;
+    if (k > n) k = n;
+
+    int *choisis = (int*)malloc(k * sizeof(int));
+    if (choisis == NULL) return -1;
+    if (meilleurs != NULL) {
+        sort_top_k_indices(cles, n, k, choisis);
+        for (int i = 0; i < k; i++) meilleurs[i] = ids[choisis[i]];
+    }
+    if (derniers != NULL) {
+        sort_bottom_k_indices(cles, n, k, choisis);
+        for (int i = 0; i < k; i++) derniers[i] = ids[choisis[i]];
+    }
+    free(choisis);
+    return k;
+}
+
+// Students present at the exam ranked by grade, ties in list order
+int note_classement_examen(liste_note *liste, int id_examen, int k, int *meilleurs, int *derniers) {
+    if (liste == NULL) return -1;
+
+    int *ids = (int*)malloc((liste->count > 0 ? liste->count : 1) * sizeof(int));
+    unsigned int *cles = (unsigned int*)malloc((liste->count > 0 ? liste->count : 1) * sizeof(unsigned int));
+    int n = 0;
+    for (int i = 0; ids != NULL && cles != NULL && i < liste->count; i++) {
+        if (liste->note[i].id_examen == id_examen && liste->note[i].present == 1) {
+            ids[n] = liste->note[i].id_etudiant;
+            cles[n] = sort_key_from_float(liste->note[i].note_obtenue);
+            n++;
+        }
+    }
+    int resultat = (ids != NULL && cles != NULL) ? note_classer(ids, cles, n, k, meilleurs, derniers) : -1;
+    free(ids);
+    free(cles);
+    return resultat;
+}
+
+// Students ranked by their average over every exam of the module
+int note_classement_module(liste_note *liste, liste_examen *examens, int id_module, int k, int *meilleurs, int *derniers) {
+    if (liste == NULL || examens == NULL) return -1;
+
+    // Exams of the module, few enough to check by scanning
+    int *ids_examens = (int*)malloc((examens->count > 0 ? examens->count : 1) * sizeof(int));
+    if (ids_examens == NULL) return -1;
+    int nb_examens = 0;
+    for (int i = 0; i < examens->count; i++) {
+        if (examens->exam[i].id_examen != TOMBSTONE_ID && examens->exam[i].id_module == id_module) {
+            ids_examens[nb_examens++] = examens->exam[i].id_examen;
+        }
+    }
+
+    NoteGroupes par_etudiant;
+    note_groupes_init(&par_etudiant);
+    int ok = 1;
+    for (int i = 0; ok && i < liste->count; i++) {
+        const Note *n = &liste->note[i];
+        if (n->id_etudiant == TOMBSTONE_ID) continue;
+        for (int j = 0; j < nb_examens; j++) {
+            if (ids_examens[j] == n->id_examen) {
+                NoteAgregat *a = note_groupes_entree(&par_etudiant, n->id_etudiant);
+                if (a == NULL) ok = 0;
+                else note_agregat_ajouter(a, n);
+                break;
+            }
+        }
+    }
+    free(ids_examens);
+
+    int *ids = (int*)malloc((par_etudiant.count > 0 ? par_etudiant.count : 1) * sizeof(int));
+    unsigned int *cles = (unsigned int*)malloc((par_etudiant.count > 0 ? par_etudiant.count : 1) * sizeof(unsigned int));
+    int n = 0;
+    for (int i = 0; ok && ids != NULL && cles != NULL && i < par_etudiant.count; i++) {
+        float moyenne = note_agregat_moyenne(&par_etudiant.groupes[i]);
+        if (moyenne >= 0) {
+            ids[n] = par_etudiant.groupes[i].id;
+            cles[n] = sort_key_from_float(moyenne);
+            n++;
+        }
+    }
+    int resultat = (ok && ids != NULL && cles != NULL) ? note_classer(ids, cles, n, k, meilleurs, derniers) : -1;
+    free(ids);
+    free(cles);
+    note_groupes_liberer(&par_etudiant);
+    return resultat;
+}
+
 void detruire_liste_notes(liste_note **liste) {
     if (*liste == NULL) return;
 
     free((*liste)->note);
     (*liste)->note = NULL;
+    free_slots_free(&(*liste)->free_slots);
+    hash_index_free(&(*liste)->index);
     (*liste)->count = 0;
     (*liste)->capacity = 0;
     free(*liste);
@@ -784,12 +1416,40 @@ void detruire_liste_notes(liste_note **liste) {
        return(cour);
 
 }
+// Position of the first module with this id, or -1
+static int cours_position(const ListeModules *liste, int id) {
+    int trouve = -1;
+    HashIndexProbe probe;
+    int slot;
+    hash_index_probe_begin(&liste->index, utils_hash_int(id), &probe);
+    while ((slot = hash_index_probe_next(&probe)) >= 0) {
+        if (slot < liste->count && (trouve < 0 || slot < trouve) &&
+            liste->cours[slot].id == id) {
+            trouve = slot;
+        }
+    }
+    return trouve;
+}
+
+// Rebuild the index after modules have been moved or reloaded
+static int liste_cours_reindexer(ListeModules *liste) {
+    hash_index_clear(&liste->index);
+    if (!hash_index_reserve(&liste->index, liste->count)) return 0;
+    for (int i = 0; i < liste->count; i++) {
+        if (liste->cours[i].id == TOMBSTONE_ID) continue;
+        if (!hash_index_insert(&liste->index, utils_hash_int(liste->cours[i].id), i))
+            return 0;
+    }
+    return 1;
+}
 //les fcts :
 ListeModules* liste_cours_creer(){
     ListeModules* coursliste=(ListeModules*)malloc(sizeof(ListeModules));
     coursliste->cours=(Module*)malloc(sizeof(Module)*300);
     coursliste->count=0;
    coursliste->capacity=300;
+   free_slots_init(&coursliste->free_slots);
+   hash_index_init(&coursliste->index);
    strcpy(coursliste->filename,"liste_des_modules.txt");
    return(coursliste);
 }
@@ -797,25 +1457,44 @@ void liste_cours_detruire(ListeModules** liste){
     if(liste==NULL || *liste==NULL) return;
     free((*liste)->cours);
     (*liste)->cours=NULL;
+    free_slots_free(&(*liste)->free_slots);
+    hash_index_free(&(*liste)->index);
     (*liste)->count=0;
     (*liste)->capacity=0;
     free(*liste);
     (*liste)=NULL;
 }
 int cours_ajouter(ListeModules* liste, Module cours){
-   if(liste->count<liste->capacity){
-    (liste)->cours[liste->count++] =cours;
-    return(1);}
-
-return(0);
+   // Reuse a tombstoned slot first
+   int slot=free_slots_pop(&liste->free_slots);
+   while(slot>=0 && (slot>=liste->count || liste->cours[slot].id!=TOMBSTONE_ID))
+       slot=free_slots_pop(&liste->free_slots);
+   if(slot<0){
+    if(liste->count>=liste->capacity) return(0);
+    slot=liste->count++;
+   }
+   liste->cours[slot]=cours;
+   if(!hash_index_insert(&liste->index,utils_hash_int(cours.id),slot)){
+    liste->cours[slot].id=TOMBSTONE_ID;
+    free_slots_push(&liste->free_slots,slot);
+    return(0);
+   }
+   return(1);
+}
+static void cours_enterrer(ListeModules* liste,int i){
+    // Tombstone instead of shifting the modules behind it
+    hash_index_remove(&liste->index,utils_hash_int(liste->cours[i].id),i);
+    memset(&liste->cours[i],0,sizeof(Module));
+    liste->cours[i].id=TOMBSTONE_ID;
+    if(!free_slots_push(&liste->free_slots,i) ||
+       free_slots_should_compact(&liste->free_slots,liste->count))
+        liste_cours_compacter(liste);
 }
 int cours_supprimer_par_nom(ListeModules* liste, char* cours_nom){
 if(liste->count!=0){
         for(int i=0;i<liste->count;i++){
-            if(strcmp((liste)->cours[i].nom,cours_nom)==0){
-                 for(int j=i;j<liste->count-1;j++)
-                   (liste)->cours[j]=(liste)->cours[j+1];
-                   liste->count--;
+            if(liste->cours[i].id!=TOMBSTONE_ID && strcmp((liste)->cours[i].nom,cours_nom)==0){
+                 cours_enterrer(liste,i);
                  return(1);
             }
         }
@@ -825,26 +1504,30 @@ if(liste->count!=0){
 return(0);
 }
 int cours_supprimer_par_id(ListeModules *liste, int cours_id){
-if(liste->count!=0){
-        for(int i=0;i<liste->count;i++){
-            if(liste->cours[i].id==cours_id){
-                 for(int j=i;j<liste->count-1;j++)
-                   (liste)->cours[j]=(liste)->cours[j+1];
-                   liste->count--;
-                 return(1);
-            }
-        }
-
-    }
-
-return(0);
+    int i=cours_position(liste,cours_id);
+    if(i<0) return(0);
+    cours_enterrer(liste,i);
+    return(1);
 }
-Module* cours_rechercher_par_id(ListeModules* liste, int cours_id){
+// Squeeze out tombstones, keeping the remaining modules in order
+void liste_cours_compacter(ListeModules* liste){
+    if(liste==NULL || liste->cours==NULL) return;
+    int vivants=0;
     for(int i=0;i<liste->count;i++){
-        if(liste->cours[i].id==cours_id)
-            return(&liste->cours[i]);
+        if(liste->cours[i].id==TOMBSTONE_ID) continue;
+        if(i!=vivants)
+            liste->cours[vivants]=liste->cours[i];
+        vivants++;
     }
-return(NULL);
+    int deplaces=vivants!=liste->count;
+    liste->count=vivants;
+    free_slots_clear(&liste->free_slots);
+    if(deplaces && !liste_cours_reindexer(liste))
+        printf("Error: failed to rebuild the module index\n");
+}
+Module* cours_rechercher_par_id(ListeModules* liste, int cours_id){
+    int i=cours_position(liste,cours_id);
+    return(i>=0 ? &liste->cours[i] : NULL);
 }
 void cours_afficher(Module* m) {
 if(m==NULL){
@@ -876,7 +1559,7 @@ void liste_cours_afficher(ListeModules* liste){
         return;
     }
 
-    if (liste->count == 0) {
+    if (liste->count - liste->free_slots.count == 0) {
         printf("No modules to display.\n");
         return;
     }
@@ -885,6 +1568,7 @@ void liste_cours_afficher(ListeModules* liste){
     printf("| ID  | Name                     | Course(h) | Tutorial(h) | Practical(h) | Sem | Teacher                    | Major     | Level     |\n");
     printf("+-----+-------------------------+----------+----------+----------+-----+-----------------------------+-----------+-----------+\n");
     for (int i = 0; i < liste->count; i++) {
+        if (liste->cours[i].id == TOMBSTONE_ID) continue;
         Module* m = &liste->cours[i];
         printf("| %-3d | %-23s | %-8d | %-8d | %-8d | %-3d | %-27s | %-9d | %-9d |\n",
             m->id,
@@ -904,8 +1588,8 @@ void cours_afficher_depuis_un_liste_par_id(ListeModules liste,int id){
         printf("No modules to display.\n");
         return;
     }
-    for (int i = 0; i < liste.count; i++) {
-            if(liste.cours[i].id==id){ Module m = liste.cours[i];
+    int i = cours_position(&liste, id);
+    if(i>=0){ Module m = liste.cours[i];
              printf("\n+-----+-------------------------+----------+----------+----------+-----+-----------------------------+-----------+-----------+\n");
     printf("| ID  | Name                     | Course(h) | Tutorial(h) | Practical(h) | Sem | Teacher                    | Major     | Level     |\n");
     printf("+-----+-------------------------+----------+----------+----------+-----+-----------------------------+-----------+-----------+\n");
@@ -920,7 +1604,6 @@ void cours_afficher_depuis_un_liste_par_id(ListeModules liste,int id){
             m.filiere,
             m.niveau
         ); return;}
-    }
     printf("The course does not exist in the list");
 }
 void cours_afficher_depuis_un_liste_par_nom(ListeModules liste,char *nom){
@@ -930,7 +1613,7 @@ void cours_afficher_depuis_un_liste_par_nom(ListeModules liste,char *nom){
         return;
     }
     for (int i = 0; i < liste.count; i++) {
-            if(strcmp(liste.cours[i].nom,nom)==0){ Module m = liste.cours[i];
+            if(liste.cours[i].id!=TOMBSTONE_ID && strcmp(liste.cours[i].nom,nom)==0){ Module m = liste.cours[i];
              printf("\n+-----+-------------------------+----------+----------+----------+-----+-----------------------------+-----------+-----------+\n");
     printf("| ID  | Name                     | Course(h) | Tutorial(h) | Practical(h) | Sem | Teacher                    | Major     | Level     |\n");
     printf("+-----+-------------------------+----------+----------+----------+-----+-----------------------------+-----------+-----------+\n");
@@ -950,7 +1633,7 @@ void cours_afficher_depuis_un_liste_par_nom(ListeModules liste,char *nom){
 }
 Module* chercher_module_par_nom(ListeModules liste,char* nom){
   for(int i=0;i<liste.count;i++){
-    if(strcmp((liste.cours[i].nom),nom)==0)
+    if(liste.cours[i].id!=TOMBSTONE_ID && strcmp((liste.cours[i].nom),nom)==0)
     {
         return(&liste.cours[i]);
     }
@@ -959,19 +1642,19 @@ Module* chercher_module_par_nom(ListeModules liste,char* nom){
   return(NULL);
 }
 Module* chercher_module_par_id(ListeModules liste,int id){
-  for(int i=0;i<liste.count;i++){
-    if(liste.cours[i].id==id)
-    {
-        return(&liste.cours[i]);
-    }
-
-  }
-  return(NULL);
+  int i=cours_position(&liste,id);
+  return(i>=0 ? &liste.cours[i] : NULL);
 }
-void modidier_cours(ListeModules liste){
+// Takes the list by pointer so that a new id can be re-indexed
+void modidier_cours(ListeModules *liste){
     int choix,id;
     printf("Enter the module ID:"); scanf("%d",&id);
-   Module *m= chercher_module_par_id(liste,id);
+   int position=cours_position(liste,id);
+   if(position<0){
+        printf("Module not found!\n");
+        return;
+   }
+   Module *m=&liste->cours[position];
     printf("\n-------------------------------------------------------------------------\n");
     printf("Choose the element you want to change:\n");
     printf("1 - Id\n");
@@ -989,7 +1672,11 @@ void modidier_cours(ListeModules liste){
     switch (choix){
     case 1:
         {
+            hash_index_remove(&liste->index,utils_hash_int(m->id),position);
             printf("Enter the new id:");scanf("%d",&m->id);
+            if(!hash_index_insert(&liste->index,utils_hash_int(m->id),position) &&
+               !liste_cours_reindexer(liste))
+                printf("Error: failed to index module %d\n",m->id);
               break;
         }
         case 2:
@@ -1036,6 +1723,8 @@ int sauvegarder_modules_ds_file(ListeModules liste){
     if(liste.count==0) return(0);
 FILE *p=fopen(liste.filename,"w");
 for(int i=0;i<liste.count;i++){
+    // Passed by value, so skip tombstones rather than compacting a copy
+    if(liste.cours[i].id==TOMBSTONE_ID) continue;
     fprintf(p,"%d,%s,%s,%d,%d,%d,%d,%d,%d,%s\n",liste.cours[i].id,
             liste.cours[i].nom,
             liste.cours[i].description,
@@ -1075,6 +1764,10 @@ int remplire_liste_appartit_file(ListeModules *liste){
        if(n == 10) {
             if(liste->count < liste->capacity) {
                 liste->cours[liste->count] = m;
+                if(!hash_index_insert(&liste->index, utils_hash_int(m.id), liste->count)) {
+                    printf(" Out of memory!\n");
+                    break;
+                }
                 liste->count++;            }
                 else {
                 printf(" List full!\n");
@@ -1088,74 +1781,55 @@ int remplire_liste_appartit_file(ListeModules *liste){
     fclose(p);
     return 1;
 }
-int trie_liste_id(ListeModules liste ,int n ){
-if(n==1){
-    for(int i=0;i<liste.count;i++){
-            Module min=liste.cours[i];
-        for(int j=1+i;j<liste.count;j++){
-            if(liste.cours[j].id<min.id){
-                      Module h=liste.cours[j];
-               liste.cours[j]=min;
-            min=h;
-            }
-        }liste.cours[i]=min;
-    }
-    return(1);
+static int cours_comparer_noms(int a, int b, const void *contexte) {
+    const ListeModules *liste = (const ListeModules*)contexte;
+    return strcmp(liste->cours[a].nom, liste->cours[b].nom);
 }
-else{
-     for(int i=0;i<liste.count;i++){
-            Module max=liste.cours[i];
-        for(int j=1+i;j<liste.count;j++){
-            if(liste.cours[j].id>max.id){
-                 Module h=liste.cours[j];
-               liste.cours[j]=max;
-            max=h;
-            }
-        }liste.cours[i]=max;
-    }
-    return(1);
+static int cours_comparer_noms_inverse(int a, int b, const void *contexte) {
+    return cours_comparer_noms(b, a, contexte);
 }
-return(0);
-}
-int trie_par_nom(int n,ListeModules liste){
-    if(n==1){
-    for(int i=0;i<liste.count;i++){
-            Module min=liste.cours[i];
-        for(int j=1+i;j<liste.count;j++){
-            if(strcmp(liste.cours[j].nom,min.nom)>0){
-                      Module h=liste.cours[j];
-               liste.cours[j]=min;
-            min=h;
-            }
-        }liste.cours[i]=min;
-    }
-    return(1);
+// Rearrange the modules of the caller's list in the given order
+static int cours_ranger(ListeModules *liste, int *ordre) {
+    if (ordre == NULL) return 0;
+    int ok = sort_apply_permutation(liste->cours, sizeof(Module), ordre, liste->count);
+    free(ordre);
+    return ok && liste_cours_reindexer(liste);
 }
-else{
-     for(int i=0;i<liste.count;i++){
-            Module max=liste.cours[i];
-        for(int j=1+i;j<liste.count;j++){
-            if(strcmp(liste.cours[j].nom,max.nom)<0){
-                 Module h=liste.cours[j];
-               liste.cours[j]=max;
-            max=h;
-            }
-        }liste.cours[i]=max;
+// n == 1: ascending ids, otherwise descending; equal ids keep their order
+int trie_liste_id(ListeModules *liste ,int n ){
+    liste_cours_compacter(liste);
+    if (liste == NULL) return 0;
+    if (liste->count < 2) return 1;
+
+    unsigned int *cles = (unsigned int*)malloc(liste->count * sizeof(unsigned int));
+    if (cles == NULL) return 0;
+    for (int i = 0; i < liste->count; i++) {
+        cles[i] = sort_key_from_int(liste->cours[i].id);
+        if (n != 1) cles[i] = ~cles[i];
     }
-    return(1);
+    int *ordre = grade_ordre(liste->count, cles, NULL, NULL);
+    free(cles);
+    return cours_ranger(liste, ordre);
 }
-return(0);
+// n == 1: names from Z to A, otherwise from A to Z
+int trie_par_nom(int n,ListeModules *liste){
+    liste_cours_compacter(liste);
+    if (liste == NULL) return 0;
+    if (liste->count < 2) return 1;
+
+    return cours_ranger(liste, grade_ordre(liste->count, NULL,
+                        n == 1 ? cours_comparer_noms_inverse : cours_comparer_noms, liste));
 }
 void liste_cours_niveau(ListeModules liste,int niveaux){
 for(int i=0;i<liste.count;i++){
-    if(liste.cours[i].niveau==niveaux){
+    if(liste.cours[i].id!=TOMBSTONE_ID && liste.cours[i].niveau==niveaux){
         cours_afficher(&liste.cours[i]);
     }
 }
 }
 void liste_cours_filiere(ListeModules liste,int filiere){
 for(int i=0;i<liste.count;i++){
-    if(liste.cours[i].filiere==filiere){
+    if(liste.cours[i].id!=TOMBSTONE_ID && liste.cours[i].filiere==filiere){
         cours_afficher(&liste.cours[i]);
     }
 }
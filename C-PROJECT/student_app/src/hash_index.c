@@ -0,0 +1,171 @@
+#include "hash_index.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Spread the caller's hash so that sequential ids do not cluster
+static unsigned long hash_index_mix(unsigned long hash) {
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3bUL;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+static int hash_index_rehash(HashIndex* index, int new_capacity) {
+    HashIndexEntry* entries = (HashIndexEntry*)malloc(sizeof(HashIndexEntry) * new_capacity);
+    if (entries == NULL) {
+        printf("Error: Failed to allocate memory for hash index\n");
+        return 0;
+    }
+    for (int i = 0; i < new_capacity; i++) {
+        entries[i].slot = HASH_INDEX_EMPTY;
+    }
+
+    unsigned long mask = (unsigned long)new_capacity - 1;
+    for (int i = 0; i < index->capacity; i++) {
+        if (index->entries[i].slot < 0) {
+            continue;
+        }
+        unsigned long pos = hash_index_mix(index->entries[i].hash) & mask;
+        while (entries[pos].slot != HASH_INDEX_EMPTY) {
+            pos = (pos + 1) & mask;
+        }
+        entries[pos] = index->entries[i];
+    }
+
+    free(index->entries);
+    index->entries = entries;
+    index->capacity = new_capacity;
+    index->deleted = 0;
+    return 1;
+}
+
+void hash_index_init(HashIndex* index) {
+    if (index == NULL) {
+        return;
+    }
+    index->entries = NULL;
+    index->capacity = 0;
+    index->count = 0;
+    index->deleted = 0;
+}
+
+void hash_index_free(HashIndex* index) {
+    if (index == NULL) {
+        return;
+    }
+    free(index->entries);
+    hash_index_init(index);
+}
+
+void hash_index_clear(HashIndex* index) {
+    if (index == NULL) {
+        return;
+    }
+    for (int i = 0; i < index->capacity; i++) {
+        index->entries[i].slot = HASH_INDEX_EMPTY;
+    }
+    index->count = 0;
+    index->deleted = 0;
+}
+
+// Make room for expected_count entries without further rehashing
+int hash_index_reserve(HashIndex* index, int expected_count) {
+    if (index == NULL || expected_count < 0) {
+        return 0;
+    }
+    // Keep the load factor (live + deleted entries) below 3/4
+    int needed = HASH_INDEX_MIN_CAPACITY;
+    while (needed / 4 * 3 <= expected_count) {
+        needed *= 2;
+    }
+    if (needed <= index->capacity && (index->count + index->deleted) < index->capacity / 4 * 3) {
+        return 1;
+    }
+    if (needed < index->capacity) {
+        needed = index->capacity;
+    }
+    return hash_index_rehash(index, needed);
+}
+
+int hash_index_insert(HashIndex* index, unsigned long hash, int slot) {
+    if (index == NULL || slot < 0) {
+        return 0;
+    }
+    if ((index->count + index->deleted + 1) >= index->capacity / 4 * 3) {
+        if (!hash_index_reserve(index, index->count + 1)) {
+            return 0;
+        }
+    }
+
+    unsigned long mask = (unsigned long)index->capacity - 1;
+    unsigned long pos = hash_index_mix(hash) & mask;
+    while (index->entries[pos].slot >= 0) {
+        pos = (pos + 1) & mask;
+    }
+    if (index->entries[pos].slot == HASH_INDEX_DELETED) {
+        index->deleted--;
+    }
+    index->entries[pos].hash = hash;
+    index->entries[pos].slot = slot;
+    index->count++;
+    return 1;
+}
+
+int hash_index_remove(HashIndex* index, unsigned long hash, int slot) {
+    if (index == NULL || index->capacity == 0) {
+        return 0;
+    }
+    unsigned long mask = (unsigned long)index->capacity - 1;
+    unsigned long pos = hash_index_mix(hash) & mask;
+    for (int steps = 0; steps < index->capacity; steps++) {
+        if (index->entries[pos].slot == HASH_INDEX_EMPTY) {
+            return 0;
+        }
+        if (index->entries[pos].slot == slot && index->entries[pos].hash == hash) {
+            index->entries[pos].slot = HASH_INDEX_DELETED;
+            index->count--;
+            index->deleted++;
+            return 1;
+        }
+        pos = (pos + 1) & mask;
+    }
+    return 0;
+}
+
+void hash_index_probe_begin(const HashIndex* index, unsigned long hash, HashIndexProbe* probe) {
+    if (probe == NULL) {
+        return;
+    }
+    probe->index = index;
+    probe->hash = hash;
+    probe->steps = 0;
+    if (index == NULL || index->capacity == 0) {
+        probe->position = 0;
+        return;
+    }
+    probe->position = hash_index_mix(hash) & ((unsigned long)index->capacity - 1);
+}
+
+// Return the next slot stored under the probe's hash, or -1 when exhausted
+int hash_index_probe_next(HashIndexProbe* probe) {
+    if (probe == NULL || probe->index == NULL) {
+        return -1;
+    }
+    const HashIndex* index = probe->index;
+    unsigned long mask = (unsigned long)index->capacity - 1;
+    while (probe->steps < index->capacity) {
+        unsigned long pos = probe->position;
+        int slot = index->entries[pos].slot;
+        if (slot == HASH_INDEX_EMPTY) {
+            probe->steps = index->capacity;
+            return -1;
+        }
+        probe->position = (pos + 1) & mask;
+        probe->steps++;
+        if (slot >= 0 && index->entries[pos].hash == probe->hash) {
+            return slot;
+        }
+    }
+    return -1;
+}
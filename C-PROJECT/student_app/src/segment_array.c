@@ -0,0 +1,75 @@
+#include "segment_array.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void segment_array_init(SegmentArray* array, size_t element_size) {
+    array->segments = NULL;
+    array->segment_count = 0;
+    array->table_capacity = 0;
+    array->element_size = element_size;
+}
+
+void segment_array_free(SegmentArray* array) {
+    for (int i = 0; i < array->segment_count; i++) {
+        free(array->segments[i]);
+    }
+    free(array->segments);
+    array->segments = NULL;
+    array->segment_count = 0;
+    array->table_capacity = 0;
+}
+
+// Make room for at least count elements. Only the table of segment
+// pointers is ever reallocated; existing segments stay where they are.
+int segment_array_reserve(SegmentArray* array, int count) {
+    if (count < 0) {
+        return 0;
+    }
+    int needed = (count + SEGMENT_ARRAY_SIZE - 1) >> SEGMENT_ARRAY_SHIFT;
+    if (needed > array->table_capacity) {
+        int table_capacity = array->table_capacity > 0 ? array->table_capacity : 4;
+        while (table_capacity < needed) {
+            table_capacity *= 2;
+        }
+        unsigned char** segments = (unsigned char**)realloc(array->segments, sizeof(unsigned char*) * table_capacity);
+        if (segments == NULL) {
+            printf("Error: Failed to allocate memory for segment table\n");
+            return 0;
+        }
+        array->segments = segments;
+        array->table_capacity = table_capacity;
+    }
+    while (array->segment_count < needed) {
+        unsigned char* segment = (unsigned char*)malloc(array->element_size * SEGMENT_ARRAY_SIZE);
+        if (segment == NULL) {
+            printf("Error: Failed to allocate memory for array segment\n");
+            return 0;
+        }
+        array->segments[array->segment_count++] = segment;
+    }
+    return 1;
+}
+
+// Release whole segments no longer needed to hold count elements
+void segment_array_trim(SegmentArray* array, int count) {
+    int needed = count > 0 ? (count + SEGMENT_ARRAY_SIZE - 1) >> SEGMENT_ARRAY_SHIFT : 0;
+    while (array->segment_count > needed) {
+        free(array->segments[--array->segment_count]);
+    }
+}
+
+int segment_array_capacity(const SegmentArray* array) {
+    return array->segment_count << SEGMENT_ARRAY_SHIFT;
+}
+
+void* segment_array_at(const SegmentArray* array, int index) {
+    return array->segments[index >> SEGMENT_ARRAY_SHIFT] +
+           (size_t)(index & (SEGMENT_ARRAY_SIZE - 1)) * array->element_size;
+}
+
+// How many of the count elements starting at index are contiguous in memory
+int segment_array_span(int index, int count) {
+    int room = SEGMENT_ARRAY_SIZE - (index & (SEGMENT_ARRAY_SIZE - 1));
+    return count < room ? count : room;
+}
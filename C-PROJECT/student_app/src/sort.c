@@ -0,0 +1,295 @@
+#include "sort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SORT_RADIX_BITS 8
+#define SORT_RADIX_BUCKETS (1 << SORT_RADIX_BITS)
+#define SORT_MERGE_INSERTION_LIMIT 16
+
+unsigned int sort_key_from_int(int value) {
+    // Flip the sign bit so negative values order before positive ones
+    return (unsigned int)value ^ 0x80000000u;
+}
+
+unsigned int sort_key_from_float(float value) {
+    union { float f; unsigned int u; } bits;
+    bits.f = value;
+    // Negative floats are stored as sign-magnitude: invert them entirely
+    if (bits.u & 0x80000000u) {
+        return ~bits.u;
+    }
+    return bits.u | 0x80000000u;
+}
+
+void sort_identity(int* order, int count) {
+    if (order == NULL) {
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        order[i] = i;
+    }
+}
+
+// Stable LSD radix sort of order[] by keys[order[i]], ascending
+int sort_radix_indices(const unsigned int* keys, int* order, int count) {
+    if (keys == NULL || order == NULL || count < 0) {
+        return 0;
+    }
+    if (count < 2) {
+        return 1;
+    }
+
+    unsigned int* key_buf = (unsigned int*)malloc(sizeof(unsigned int) * count * 2);
+    int* order_buf = (int*)malloc(sizeof(int) * count);
+    if (key_buf == NULL || order_buf == NULL) {
+        printf("Error: Failed to allocate memory for radix sort\n");
+        free(key_buf);
+        free(order_buf);
+        return 0;
+    }
+
+    // Keys travel with their positions so each pass reads sequentially
+    unsigned int* src_keys = key_buf;
+    unsigned int* dst_keys = key_buf + count;
+    int* src_order = order;
+    int* dst_order = order_buf;
+    for (int i = 0; i < count; i++) {
+        src_keys[i] = keys[order[i]];
+    }
+
+    for (int shift = 0; shift < 32; shift += SORT_RADIX_BITS) {
+        int histogram[SORT_RADIX_BUCKETS] = {0};
+        for (int i = 0; i < count; i++) {
+            histogram[(src_keys[i] >> shift) & (SORT_RADIX_BUCKETS - 1)]++;
+        }
+        // Every key shares this digit: the pass would not move anything
+        if (histogram[(src_keys[0] >> shift) & (SORT_RADIX_BUCKETS - 1)] == count) {
+            continue;
+        }
+
+        int offset = 0;
+        for (int b = 0; b < SORT_RADIX_BUCKETS; b++) {
+            int n = histogram[b];
+            histogram[b] = offset;
+            offset += n;
+        }
+        for (int i = 0; i < count; i++) {
+            int pos = histogram[(src_keys[i] >> shift) & (SORT_RADIX_BUCKETS - 1)]++;
+            dst_keys[pos] = src_keys[i];
+            dst_order[pos] = src_order[i];
+        }
+
+        unsigned int* tmp_keys = src_keys;
+        src_keys = dst_keys;
+        dst_keys = tmp_keys;
+        int* tmp_order = src_order;
+        src_order = dst_order;
+        dst_order = tmp_order;
+    }
+
+    if (src_order != order) {
+        memcpy(order, src_order, sizeof(int) * count);
+    }
+    free(key_buf);
+    free(order_buf);
+    return 1;
+}
+
+static void sort_merge_range(int* order, int* buffer, int left, int right,
+                             SortCompareFunc compare, const void* context) {
+    if (right - left <= SORT_MERGE_INSERTION_LIMIT) {
+        for (int i = left + 1; i < right; i++) {
+            int value = order[i];
+            int j = i - 1;
+            while (j >= left && compare(order[j], value, context) > 0) {
+                order[j + 1] = order[j];
+                j--;
+            }
+            order[j + 1] = value;
+        }
+        return;
+    }
+
+    int middle = left + (right - left) / 2;
+    sort_merge_range(order, buffer, left, middle, compare, context);
+    sort_merge_range(order, buffer, middle, right, compare, context);
+
+    // Halves already in order: nothing to merge
+    if (compare(order[middle - 1], order[middle], context) <= 0) {
+        return;
+    }
+
+    int i = left, j = middle, k = left;
+    while (i < middle && j < right) {
+        if (compare(order[j], order[i], context) < 0) {
+            buffer[k++] = order[j++];
+        } else {
+            buffer[k++] = order[i++];
+        }
+    }
+    while (i < middle) {
+        buffer[k++] = order[i++];
+    }
+    while (j < right) {
+        buffer[k++] = order[j++];
+    }
+    memcpy(order + left, buffer + left, sizeof(int) * (right - left));
+}
+
+// Stable merge sort of order[] using compare on record positions
+int sort_merge_indices(int* order, int count, SortCompareFunc compare, const void* context) {
+    if (order == NULL || compare == NULL || count < 0) {
+        return 0;
+    }
+    if (count < 2) {
+        return 1;
+    }
+
+    int* buffer = (int*)malloc(sizeof(int) * count);
+    if (buffer == NULL) {
+        printf("Error: Failed to allocate memory for merge sort\n");
+        return 0;
+    }
+    sort_merge_range(order, buffer, 0, count, compare, context);
+    free(buffer);
+    return 1;
+}
+
+// Element accessor for sort_apply_permutation's contiguous array
+typedef struct {
+    unsigned char* base;
+    size_t element_size;
+} SortContiguous;
+
+static void* sort_contiguous_element(int index, void* context) {
+    SortContiguous* array = (SortContiguous*)context;
+    return array->base + (size_t)index * array->element_size;
+}
+
+// Rearrange base so that the new element i is the old element order[i]
+int sort_apply_permutation(void* base, size_t element_size, const int* order, int count) {
+    if (base == NULL) {
+        return 0;
+    }
+    SortContiguous array = { (unsigned char*)base, element_size };
+    return sort_apply_permutation_at(sort_contiguous_element, &array, element_size, order, count);
+}
+
+// Same for records reached through element(). Follows permutation cycles,
+// so every element is moved exactly once.
+int sort_apply_permutation_at(SortElementFunc element, void* context, size_t element_size,
+                              const int* order, int count) {
+    if (element == NULL || order == NULL || count < 0) {
+        return 0;
+    }
+    if (count < 2) {
+        return 1;
+    }
+
+    unsigned char* placed = (unsigned char*)calloc(count, 1);
+    unsigned char* held = (unsigned char*)malloc(element_size);
+    if (placed == NULL || held == NULL) {
+        printf("Error: Failed to allocate memory for permutation\n");
+        free(placed);
+        free(held);
+        return 0;
+    }
+
+    for (int start = 0; start < count; start++) {
+        if (placed[start] || order[start] == start) {
+            placed[start] = 1;
+            continue;
+        }
+        memcpy(held, element(start, context), element_size);
+        int current = start;
+        while (1) {
+            int next = order[current];
+            placed[current] = 1;
+            if (next == start) {
+                memcpy(element(current, context), held, element_size);
+                break;
+            }
+            memcpy(element(current, context), element(next, context), element_size);
+            current = next;
+        }
+    }
+
+    free(placed);
+    free(held);
+    return 1;
+}
+
+// Whether position a is further out than b for the selection direction
+static int sort_select_beats(const unsigned int* keys, int a, int b, int bottom) {
+    if (keys[a] != keys[b]) {
+        return bottom ? keys[a] < keys[b] : keys[a] > keys[b];
+    }
+    return bottom ? a > b : a < b;
+}
+
+// Restore the heap below root; the root is the position beaten by all others
+static void sort_select_sift_down(const unsigned int* keys, int* heap, int size, int root, int bottom) {
+    while (1) {
+        int weakest = root;
+        int left = 2 * root + 1;
+        int right = left + 1;
+        if (left < size && sort_select_beats(keys, heap[weakest], heap[left], bottom)) {
+            weakest = left;
+        }
+        if (right < size && sort_select_beats(keys, heap[weakest], heap[right], bottom)) {
+            weakest = right;
+        }
+        if (weakest == root) {
+            return;
+        }
+        int held = heap[root];
+        heap[root] = heap[weakest];
+        heap[weakest] = held;
+        root = weakest;
+    }
+}
+
+// Bounded heap held in out itself: O(count log k) time, no allocation
+static int sort_select_k(const unsigned int* keys, int count, int k, int* out, int bottom) {
+    if (keys == NULL || out == NULL || count <= 0 || k <= 0) {
+        return 0;
+    }
+    int size = 0;
+    for (int i = 0; i < count; i++) {
+        if (size < k) {
+            // Sift the new position up past every entry it does not beat
+            int child = size++;
+            out[child] = i;
+            while (child > 0) {
+                int parent = (child - 1) / 2;
+                if (!sort_select_beats(keys, out[parent], out[child], bottom)) {
+                    break;
+                }
+                int held = out[parent];
+                out[parent] = out[child];
+                out[child] = held;
+                child = parent;
+            }
+        } else if (sort_select_beats(keys, i, out[0], bottom)) {
+            out[0] = i;
+            sort_select_sift_down(keys, out, size, 0, bottom);
+        }
+    }
+    // Pop the weakest to the back until the strongest is in front
+    for (int end = size - 1; end > 0; end--) {
+        int held = out[0];
+        out[0] = out[end];
+        out[end] = held;
+        sort_select_sift_down(keys, out, end, 0, bottom);
+    }
+    return size;
+}
+
+int sort_top_k_indices(const unsigned int* keys, int count, int k, int* out) {
+    return sort_select_k(keys, count, k, out, 0);
+}
+
+int sort_bottom_k_indices(const unsigned int* keys, int count, int k, int* out) {
+    return sort_select_k(keys, count, k, out, 1);
+}
@@ -1,28 +1,17 @@
 #include "stats.h"
+#include "sort.h"
 
 // Type aliases to match header declarations
 typedef liste_note GradeList;
 typedef ListeModules CourseList;
 typedef Note Grade;
 
-// Helper function to calculate student GPA from note list
-static float calculate_student_gpa_from_notes(GradeList* notes, int student_id) {
-    if (!notes || notes->count == 0) return -1.0f;
-    
-    float total_grade = 0.0f;
-    int count = 0;
-    
-    for (int i = 0; i < notes->count; i++) {
-        if (notes->note[i].id_etudiant == student_id && notes->note[i].present == 1) {
-            // Convert 0-20 scale to 0-4 GPA scale
-            float gpa_value = (notes->note[i].note_obtenue / 20.0f) * 4.0f;
-            total_grade += gpa_value;
-            count++;
-        }
-    }
-    
-    if (count == 0) return -1.0f;
-    return total_grade / count;
+// GPA on the 0-4 scale from a student's grade totals, or -1 without any
+static float student_gpa_from_aggregate(const NoteAgregat* grades) {
+    float average = note_agregat_moyenne(grades);
+    if (average < 0) return -1.0f;
+    // Convert 0-20 scale to 0-4 GPA scale
+    return (average / 20.0f) * 4.0f;
 }
 
 // Helper function to convert grade level to numeric GPA
@@ -45,11 +34,15 @@ SystemStats* calculate_system_stats(StudentList* students, CourseList* courses,
     
     memset(stats, 0, sizeof(SystemStats));
     
+    // Deleted records keep their slots until compaction: count live ones only
+    
     // Count students
     if (students) {
-        stats->total_students = students->count;
+        stats->total_students = student_list_get_count(students);
         for (int i = 0; i < students->count; i++) {
-            if (students->students[i].is_active) {
+            Student* s = student_list_get_student(students, i);
+            if (s == NULL) continue;
+            if (s->is_active) {
                 stats->active_students++;
             } else {
                 stats->inactive_students++;
@@ -59,27 +52,27 @@ SystemStats* calculate_system_stats(StudentList* students, CourseList* courses,
     
     // Count courses
     if (courses) {
-        stats->total_courses = courses->count;
+        stats->total_courses = courses->count - courses->free_slots.count;
     }
     
     // Count grades
     if (grades) {
-        stats->total_grades = grades->count;
+        stats->total_grades = grades->count - grades->free_slots.count;
     }
     
     // Count attendance records
     if (attendance) {
-        stats->total_attendance_records = attendance->count;
+        stats->total_attendance_records = attendance->count - attendance->free_slots.count;
     }
     
     // Count clubs
     if (clubs) {
-        stats->total_clubs = clubs->count;
+        stats->total_clubs = clubs->count - clubs->free_slots.count;
     }
     
     // Count memberships
     if (memberships) {
-        stats->total_memberships = memberships->count;
+        stats->total_memberships = memberships->count - memberships->free_slots.count;
     }
     
     stats->last_updated = time(NULL);
@@ -121,21 +114,22 @@ void free_system_stats(SystemStats* stats) {
 
 
 StudentStats* calculate_student_stats(StudentList* students, GradeList* grades) {
-    if (!students || students->count == 0) return NULL;
+    if (!students || student_list_get_count(students) == 0) return NULL;
     
     StudentStats* stats = (StudentStats*)malloc(sizeof(StudentStats));
     if (!stats) return NULL;
     
     memset(stats, 0, sizeof(StudentStats));
     
-    stats->total_students = students->count;
+    stats->total_students = student_list_get_count(students);
     
     int total_age = 0;
     int student_count_with_age = 0;
     
     // Calculate statistics for each student
     for (int i = 0; i < students->count; i++) {
-        Student* s = &students->students[i];
+        Student* s = student_list_get_student(students, i);
+        if (s == NULL) continue;  // Deleted
         
         // Count by year
         if (s->year >= 1 && s->year <= 4) {
@@ -172,17 +166,25 @@ StudentStats* calculate_student_stats(StudentList* students, GradeList* grades)
             float gpa;
         } StudentGPA;
         
+        // One pass over the grades gives every student's totals
+        NoteGroupes by_student;
+        note_groupes_init(&by_student);
         StudentGPA* student_gpas = (StudentGPA*)malloc(sizeof(StudentGPA) * students->count);
-        if (!student_gpas) {
+        if (!student_gpas || !note_grouper(grades, &by_student, NULL)) {
+            free(student_gpas);
+            note_groupes_liberer(&by_student);
             free(stats);
             return NULL;
         }
         
         // Calculate GPA for each student
         for (int i = 0; i < students->count; i++) {
-            float gpa = calculate_student_gpa_from_notes(grades, students->students[i].id);
+            Student* s = student_list_get_student(students, i);
+            if (s == NULL) continue;
+            int student_id = s->id;
+            float gpa = student_gpa_from_aggregate(note_groupes_chercher(&by_student, student_id));
             if (gpa >= 0) {
-                student_gpas[student_gpa_count].student_id = students->students[i].id;
+                student_gpas[student_gpa_count].student_id = student_id;
                 student_gpas[student_gpa_count].gpa = gpa;
                 total_gpa += gpa;
                 student_gpa_count++;
@@ -194,32 +196,32 @@ StudentStats* calculate_student_stats(StudentList* students, GradeList* grades)
                 stats->gpa_distribution[gpa_index]++;
             }
         }
+        note_groupes_liberer(&by_student);
         
         if (student_gpa_count > 0) {
             stats->average_gpa = total_gpa / student_gpa_count;
             
-            // Sort by GPA for top/bottom performers
-            for (int i = 0; i < student_gpa_count - 1; i++) {
-                for (int j = 0; j < student_gpa_count - i - 1; j++) {
-                    if (student_gpas[j].gpa < student_gpas[j + 1].gpa) {
-                        StudentGPA temp = student_gpas[j];
-                        student_gpas[j] = student_gpas[j + 1];
-                        student_gpas[j + 1] = temp;
-                    }
+            // Only the two ends of the GPA ranking are kept: select them
+            // instead of sorting every student
+            unsigned int* keys = (unsigned int*)malloc(sizeof(unsigned int) * student_gpa_count);
+            if (keys) {
+                for (int i = 0; i < student_gpa_count; i++) {
+                    keys[i] = sort_key_from_float(student_gpas[i].gpa);
                 }
-            }
-            
-            // Top 10 performers
-            int top_count = (student_gpa_count < 10) ? student_gpa_count : 10;
-            for (int i = 0; i < top_count; i++) {
-                stats->top_performers[i] = student_gpas[i].student_id;
-            }
-            
-            // Bottom 10 performers (struggling students) - reverse order
-            int bottom_count = (student_gpa_count < 10) ? student_gpa_count : 10;
-            int start_idx = student_gpa_count - bottom_count;
-            for (int i = 0; i < bottom_count; i++) {
-                stats->struggling_students[i] = student_gpas[start_idx + i].student_id;
+                int picked[STATS_RANKING_SIZE];
+                
+                // Top performers, best first
+                int top_count = sort_top_k_indices(keys, student_gpa_count, STATS_RANKING_SIZE, picked);
+                for (int i = 0; i < top_count; i++) {
+                    stats->top_performers[i] = student_gpas[picked[i]].student_id;
+                }
+                
+                // Struggling students, worst last
+                int bottom_count = sort_bottom_k_indices(keys, student_gpa_count, STATS_RANKING_SIZE, picked);
+                for (int i = 0; i < bottom_count; i++) {
+                    stats->struggling_students[bottom_count - 1 - i] = student_gpas[picked[i]].student_id;
+                }
+                free(keys);
             }
         }
         
@@ -269,9 +271,9 @@ void display_student_stats(StudentStats* stats) {
     }
     printf("\n");
     
-    printf("Top 10 Performers (Student IDs): ");
+    printf("Top %d Performers (Student IDs): ", STATS_RANKING_SIZE);
     int found_top = 0;
-    for (int i = 0; i < 10 && stats->top_performers[i] != 0; i++) {
+    for (int i = 0; i < STATS_RANKING_SIZE && stats->top_performers[i] != 0; i++) {
         if (found_top > 0) printf(", ");
         printf("%d", stats->top_performers[i]);
         found_top++;
@@ -281,7 +283,7 @@ void display_student_stats(StudentStats* stats) {
     
     printf("Struggling Students (Student IDs): ");
     int found_struggling = 0;
-    for (int i = 0; i < 10 && stats->struggling_students[i] != 0; i++) {
+    for (int i = 0; i < STATS_RANKING_SIZE && stats->struggling_students[i] != 0; i++) {
         if (found_struggling > 0) printf(", ");
         printf("%d", stats->struggling_students[i]);
         found_struggling++;
@@ -300,14 +302,14 @@ void free_student_stats(StudentStats* stats) {
 
 
 GradeStats* calculate_grade_stats(GradeList* grades, CourseList* courses) {
-    if (!grades || grades->count == 0) return NULL;
+    if (!grades || grades->count - grades->free_slots.count == 0) return NULL;
     
     GradeStats* stats = (GradeStats*)malloc(sizeof(GradeStats));
     if (!stats) return NULL;
     
     memset(stats, 0, sizeof(GradeStats));
     
-    stats->total_grades = grades->count;
+    stats->total_grades = grades->count - grades->free_slots.count;
     stats->highest_gpa = 0.0;
     stats->lowest_gpa = 4.1f;  // Initialize higher than max possible GPA (4.0)
     
@@ -318,6 +320,7 @@ GradeStats* calculate_grade_stats(GradeList* grades, CourseList* courses) {
     for (int i = 0; i < grades->count; i++) {
         Grade* g = &grades->note[i];
         
+        if (g->id_etudiant == TOMBSTONE_ID) continue;  // Deleted
         if (g->present == 0) continue;  // Skip absent students
         
         // Convert 0-20 scale to grade level (A=16-20, B=14-15, C=12-13, D=10-11, F=0-9)
@@ -412,47 +415,21 @@ void free_grade_stats(GradeStats* stats) {
 
 
 AttendanceStats* calculate_attendance_stats(AttendanceList* attendance) {
-    if (!attendance || attendance->count == 0) return NULL;
+    // The list keeps these totals up to date on every write, so reading
+    // them costs the same whatever the size of the history
+    const AttendanceTally* tally = attendance_list_tally(attendance);
+    if (!tally || tally->total == 0) return NULL;
     
     AttendanceStats* stats = (AttendanceStats*)malloc(sizeof(AttendanceStats));
     if (!stats) return NULL;
     
     memset(stats, 0, sizeof(AttendanceStats));
     
-    stats->total_records = attendance->count;
-    
-    int month_counts[12] = {0};
-    
-    // Analyze each attendance record
-    for (int i = 0; i < attendance->count; i++) {
-        AttendanceRecord* a = &attendance->records[i];
-        
-        // Count by status
-        switch (a->status) {
-            case ATTENDANCE_PRESENT:
-                stats->present_count++;
-                break;
-            case ATTENDANCE_ABSENT:
-                stats->absent_count++;
-                break;
-            case ATTENDANCE_LATE:
-                stats->late_count++;
-                break;
-            case ATTENDANCE_EXCUSED:
-                stats->excused_count++;
-                break;
-        }
-        
-        // Count by month
-        struct tm* date_tm = localtime(&a->date);
-        int month = date_tm->tm_mon;
-        if (month >= 0 && month < 12) {
-            month_counts[month]++;
-            if (a->status == ATTENDANCE_PRESENT || a->status == ATTENDANCE_LATE) {
-                stats->attendance_by_month[month]++;
-            }
-        }
-    }
+    stats->total_records = tally->total;
+    stats->present_count = tally->by_status[ATTENDANCE_PRESENT];
+    stats->absent_count = tally->by_status[ATTENDANCE_ABSENT];
+    stats->late_count = tally->by_status[ATTENDANCE_LATE];
+    stats->excused_count = tally->by_status[ATTENDANCE_EXCUSED];
     
     // Calculate overall attendance rate
     int total_countable = stats->present_count + stats->absent_count + 
@@ -464,12 +441,16 @@ AttendanceStats* calculate_attendance_stats(AttendanceList* attendance) {
     
     // Calculate monthly attendance rates
     for (int i = 0; i < 12; i++) {
-        if (month_counts[i] > 0) {
+        if (tally->month_marked[i] > 0) {
             stats->attendance_by_month[i] = 
-                (float)stats->attendance_by_month[i] / month_counts[i] * 100.0;
+                (float)tally->month_attended[i] / tally->month_marked[i] * 100.0;
         }
     }
     
+    // Counted per session off the course bitmaps, not per record
+    stats->students_with_perfect_attendance = tally->perfect_students;
+    stats->students_with_poor_attendance = tally->poor_students;
+    
     return stats;
 }
 
@@ -489,7 +470,9 @@ void display_attendance_stats(AttendanceStats* stats) {
     printf("  Excused: %d\n", stats->excused_count);
     printf("\n");
     
-    printf("Overall Attendance Rate: %.1f%%\n\n", stats->overall_attendance_rate);
+    printf("Overall Attendance Rate: %.1f%%\n", stats->overall_attendance_rate);
+    printf("Perfect Attendance: %d student(s)\n", stats->students_with_perfect_attendance);
+    printf("Below %.0f%% Attendance: %d student(s)\n\n", POOR_ATTENDANCE_RATE, stats->students_with_poor_attendance);
     
     printf("Monthly Attendance Rates:\n");
     const char* months[] = {
@@ -513,14 +496,14 @@ void free_attendance_stats(AttendanceStats* stats) {
 
 
 ClubStats* calculate_club_stats(ClubList* clubs, MembershipList* memberships) {
-    if (!clubs || clubs->count == 0) return NULL;
+    if (!clubs || clubs->count - clubs->free_slots.count == 0) return NULL;
     
     ClubStats* stats = (ClubStats*)malloc(sizeof(ClubStats));
     if (!stats) return NULL;
     
     memset(stats, 0, sizeof(ClubStats));
     
-    stats->total_clubs = clubs->count;
+    stats->total_clubs = clubs->count - clubs->free_slots.count;
     
     int max_members = -1;
     int min_members = -1;
@@ -529,6 +512,7 @@ ClubStats* calculate_club_stats(ClubList* clubs, MembershipList* memberships) {
     // Analyze each club
     for (int i = 0; i < clubs->count; i++) {
         Club* c = &clubs->clubs[i];
+        if (c->id == TOMBSTONE_ID) continue;  // Deleted
         
         if (c->is_active) {
             stats->active_clubs++;
@@ -538,7 +522,8 @@ ClubStats* calculate_club_stats(ClubList* clubs, MembershipList* memberships) {
         int club_members = 0;
         if (memberships) {
             for (int j = 0; j < memberships->count; j++) {
-                if (memberships->memberships[j].club_id == c->id &&
+                if (memberships->memberships[j].id != TOMBSTONE_ID &&
+                    memberships->memberships[j].club_id == c->id &&
                     memberships->memberships[j].is_active) {
                     club_members++;
                 }
@@ -562,6 +547,7 @@ ClubStats* calculate_club_stats(ClubList* clubs, MembershipList* memberships) {
     // Count total memberships
     if (memberships) {
         for (int i = 0; i < memberships->count; i++) {
+            if (memberships->memberships[i].id == TOMBSTONE_ID) continue;
             stats->total_memberships++;
             if (memberships->memberships[i].is_active) {
                 stats->active_memberships++;
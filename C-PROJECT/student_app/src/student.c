@@ -9,9 +9,177 @@
 #include "attendance.h"
 #include "grade.h"
 #include "club.h"
+#include "utils.h"
+#include "sort.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <glib.h>
+
+// Bounds of str once surrounding whitespace is ignored
+static void student_key_bounds(const char* str, const char** start, const char** end) {
+    const char* s = str;
+    const char* e = str + strlen(str);
+    while (s < e && isspace((unsigned char)*s)) {
+        s++;
+    }
+    while (e > s && isspace((unsigned char)e[-1])) {
+        e--;
+    }
+    *start = s;
+    *end = e;
+}
+
+// djb2 over the lower-cased, trimmed string (see utils_hash_string)
+static unsigned long student_hash_normalized(const char* str) {
+    const char* s;
+    const char* e;
+    unsigned long hash = 5381;
+    student_key_bounds(str, &s, &e);
+    for (; s < e; s++) {
+        hash = ((hash << 5) + hash) + (unsigned long)tolower((unsigned char)*s);
+    }
+    return hash;
+}
+
+// Case-insensitive comparison that ignores surrounding whitespace
+static int student_equals_normalized(const char* a, const char* b) {
+    const char* as;
+    const char* ae;
+    const char* bs;
+    const char* be;
+    student_key_bounds(a, &as, &ae);
+    student_key_bounds(b, &bs, &be);
+    if (ae - as != be - bs) {
+        return 0;
+    }
+    for (; as < ae; as++, bs++) {
+        if (tolower((unsigned char)*as) != tolower((unsigned char)*bs)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static unsigned long student_name_hash(const char* first_name, const char* last_name) {
+    return utils_hash_combine(student_hash_normalized(last_name), student_hash_normalized(first_name));
+}
+
+// Record at position slot; slot must be below the reserved capacity
+static Student* student_list_at(const StudentList* list, int slot) {
+    return (Student*)segment_array_at(&list->students, slot);
+}
+
+static int student_list_is_live(const StudentList* list, int slot) {
+    return student_list_at(list, slot)->id != TOMBSTONE_ID;
+}
+
+// Length of the run of live records starting at slot that is contiguous in memory
+static int student_list_live_run(const StudentList* list, int slot) {
+    int span = segment_array_span(slot, list->count - slot);
+    int run = 0;
+    while (run < span && student_list_is_live(list, slot + run)) {
+        run++;
+    }
+    return run;
+}
+
+// Add the record at position slot to every lookup index
+static int student_list_index_student(StudentList* list, int slot) {
+    Student* s = student_list_at(list, slot);
+    return hash_index_insert(&list->id_index, utils_hash_int(s->id), slot) &&
+           hash_index_insert(&list->email_index, student_hash_normalized(s->email), slot) &&
+           hash_index_insert(&list->name_index, student_name_hash(s->first_name, s->last_name), slot);
+}
+
+static void student_list_unindex_student(StudentList* list, int slot) {
+    Student* s = student_list_at(list, slot);
+    hash_index_remove(&list->id_index, utils_hash_int(s->id), slot);
+    hash_index_remove(&list->email_index, student_hash_normalized(s->email), slot);
+    hash_index_remove(&list->name_index, student_name_hash(s->first_name, s->last_name), slot);
+}
+
+static void student_list_free_indexes(StudentList* list) {
+    hash_index_free(&list->id_index);
+    hash_index_free(&list->email_index);
+    hash_index_free(&list->name_index);
+}
+
+// Rebuild the lookup indexes after records have been moved or reloaded
+static int student_list_rebuild_indexes(StudentList* list) {
+    hash_index_clear(&list->id_index);
+    hash_index_clear(&list->email_index);
+    hash_index_clear(&list->name_index);
+    if (!hash_index_reserve(&list->id_index, list->count) ||
+        !hash_index_reserve(&list->email_index, list->count) ||
+        !hash_index_reserve(&list->name_index, list->count)) {
+        return 0;
+    }
+    for (int i = 0; i < list->count; i++) {
+        if (student_list_is_live(list, i) && !student_list_index_student(list, i)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Position of the earliest record with this id, or -1. Duplicate ids are
+// allowed, so every candidate is checked.
+static int student_list_slot_of_id(const StudentList* list, int student_id) {
+    int found = -1;
+    HashIndexProbe probe;
+    int slot;
+    hash_index_probe_begin(&list->id_index, utils_hash_int(student_id), &probe);
+    while ((slot = hash_index_probe_next(&probe)) >= 0) {
+        if (slot < list->count && (found < 0 || slot < found) &&
+            student_list_at(list, slot)->id == student_id) {
+            found = slot;
+        }
+    }
+    return found;
+}
+
+// Mark the list dirty and queue the mutation for the journal. Only lists
+// backed by a loaded file are journaled, which also keeps replay from
+// re-recording what it applies.
+static void student_list_journal_note(StudentList* list, StudentJournalOp op, int student_id, const Student* student) {
+    list->dirty_generation++;
+    if (!list->is_loaded || list->filename[0] == '\0') {
+        return;
+    }
+    if (list->journal_pending_count >= list->journal_pending_capacity) {
+        int capacity = list->journal_pending_capacity > 0 ? list->journal_pending_capacity * 2 : 16;
+        StudentJournalRecord* grown = realloc(list->journal_pending, sizeof(StudentJournalRecord) * capacity);
+        if (grown == NULL) {
+            // The change is still in memory; the next save rewrites everything
+            list->journal_needs_compaction = 1;
+            return;
+        }
+        list->journal_pending = grown;
+        list->journal_pending_capacity = capacity;
+    }
+    StudentJournalRecord* record = &list->journal_pending[list->journal_pending_count++];
+    memset(record, 0, sizeof(*record));
+    record->op = (unsigned int)op;
+    record->student_id = student_id;
+    if (student != NULL) {
+        record->student = *student;
+    }
+    record->checksum = utils_hash_adler32(1, record, sizeof(*record));
+}
+
+static void student_list_journal_reset(StudentList* list) {
+    free(list->journal_pending);
+    list->journal_pending = NULL;
+    list->journal_pending_count = 0;
+    list->journal_pending_capacity = 0;
+    list->journal_records = 0;
+    list->journal_needs_compaction = 1;
+    list->journal_base_size = 0;
+    list->journal_base_time = 0;
+}
 
 StudentList* student_list_create(void) {
     StudentList* list = (StudentList*)malloc(sizeof(StudentList));
@@ -20,23 +188,26 @@ StudentList* student_list_create(void) {
         return NULL;
     }
     
-    // Allocate memory for the students array
-    list->students = (Student*)malloc(MAX_STUDENTS * sizeof(Student));
-    if (list->students == NULL) {
-        printf("Error: Failed to allocate memory for students array\n");
-        free(list);
-        return NULL;
-    }
+    // Records are allocated segment by segment as the list grows
+    segment_array_init(&list->students, sizeof(Student));
+    free_slots_init(&list->free_slots);
     
     // Initialize all fields
     list->count = 0;
-    list->capacity = MAX_STUDENTS;
     list->is_loaded = 0;
     // Set the first character of the filename to the null terminator,
     // making the filename an empty string to indicate no file is set yet.
     list->filename[0] = '\0';
     list->auto_save_enabled = 1;
     list->last_save_time = 0;
+    hash_index_init(&list->id_index);
+    hash_index_init(&list->email_index);
+    hash_index_init(&list->name_index);
+    list->journal_pending = NULL;
+    student_list_journal_reset(list);
+    list->dirty_generation = 0;
+    list->saved_generation = 0;
+    list->auto_saver = NULL;
     
     return list;
 }
@@ -45,26 +216,55 @@ void student_list_destroy(StudentList* list) {
     if (list == NULL) {
         return;
     }
+    student_list_stop_auto_save(list);
     
-    // Free the students array if it was allocated
-    if (list->students != NULL) {
-        free(list->students);
-    }
+    // Free the student records
+    segment_array_free(&list->students);
+    free_slots_free(&list->free_slots);
+    student_list_free_indexes(list);
+    free(list->journal_pending);
     
     // Free the list structure itself
     free(list);
 }
+// Checks shared by every insert path; prints why a record is refused
+static int student_list_accepts(const Student* student) {
+    if (student->id == TOMBSTONE_ID) {
+        printf("Error: Invalid student id %d\n", student->id);
+        return 0;
+    }
+    return student_validate_age(student->age) && student_validate_gpa(student->gpa);
+}
+
 int student_list_add(StudentList* list, Student student){
-    if (list == NULL || list->students == NULL) {
+    if (list == NULL) {
         printf("ERROR DE LISTE OR STUDENT  ");
         return 0;
+    }else if (!student_list_accepts(&student)) {
+        return 0;
     }else{
-        if (list->count >= list->capacity) {
-            printf("Error: Student list is full, cannot add new student.\n");
+        // Reuse a tombstoned slot before growing
+        int slot = free_slots_pop(&list->free_slots);
+        while (slot >= 0 && (slot >= list->count || student_list_is_live(list, slot))) {
+            slot = free_slots_pop(&list->free_slots);
+        }
+        if (slot < 0) {
+            // Grows by a whole segment when needed; existing records stay put
+            if (!segment_array_reserve(&list->students, list->count + 1)) {
+                printf("Error: Student list is full, cannot add new student.\n");
+                return 0;
+            }
+            slot = list->count++;
+        }
+        *student_list_at(list, slot) = student;
+        if (!student_list_index_student(list, slot)) {
+            printf("Error: Failed to index student %d\n", student.id);
+            student_list_unindex_student(list, slot);
+            student_list_at(list, slot)->id = TOMBSTONE_ID;
+            free_slots_push(&list->free_slots, slot);
             return 0;
         }
-        list->students[list->count] = student;
-        list->count++;
+        student_list_journal_note(list, STUDENT_JOURNAL_ADD, student.id, &student);
         return 1;
     }
 
@@ -72,43 +272,122 @@ int student_list_add(StudentList* list, Student student){
 
 
 }
-int student_list_remove(StudentList* list, int student_id) {
-    if (list == NULL || list->students == NULL) {
-        printf("Error: Invalid student list\n");
+
+// Append count students at once. The batch is validated up front and
+// added all-or-nothing: storage and indexes are reserved once, records are
+// copied a segment at a time, and a batch too large to journal cheaply
+// marks the file for a full rewrite instead. Returns the number added.
+int student_list_add_many(StudentList* list, const Student* students, int count) {
+    if (list == NULL || (students == NULL && count > 0) || count < 0) {
+        printf("Error: Invalid student batch\n");
+        return 0;
+    }
+    for (int i = 0; i < count; i++) {
+        if (!student_list_accepts(&students[i])) {
+            printf("Error: Invalid student at position %d (id %d), nothing added\n", i, students[i].id);
+            return 0;
+        }
+    }
+    if (count == 0) {
         return 0;
     }
 
-    for (int i = 0; i < list->count; i++) {
-        if (list->students[i].id == student_id) {
-            for (int j = i; j < list->count - 1; j++) {
-                list->students[j] = list->students[j + 1];
+    int first = list->count;
+    if (!segment_array_reserve(&list->students, first + count) ||
+        !hash_index_reserve(&list->id_index, first + count) ||
+        !hash_index_reserve(&list->email_index, first + count) ||
+        !hash_index_reserve(&list->name_index, first + count)) {
+        printf("Error: Not enough memory for %d students\n", count);
+        return 0;
+    }
+
+    for (int copied = 0; copied < count; ) {
+        int run = segment_array_span(first + copied, count - copied);
+        memcpy(student_list_at(list, first + copied), &students[copied], sizeof(Student) * (size_t)run);
+        copied += run;
+    }
+    for (int i = 0; i < count; i++) {
+        if (!student_list_index_student(list, first + i)) {
+            printf("Error: Failed to index student %d\n", students[i].id);
+            for (int j = 0; j <= i; j++) {
+                student_list_unindex_student(list, first + j);
             }
+            return 0;
+        }
+    }
+    list->count = first + count;
+
+    int journaled = list->journal_records + list->journal_pending_count + count;
+    if (journaled > list->count / 2 + STUDENT_JOURNAL_COMPACT_SLACK) {
+        // The next save would compact anyway; skip queueing the records
+        list->journal_needs_compaction = 1;
+        list->dirty_generation++;
+    } else {
+        for (int i = 0; i < count; i++) {
+            student_list_journal_note(list, STUDENT_JOURNAL_ADD, students[i].id, &students[i]);
+        }
+    }
+    return count;
+}
+int student_list_remove(StudentList* list, int student_id) {
+    if (list == NULL) {
+        printf("Error: Invalid student list\n");
+        return 0;
+    }
 
-            memset(&list->students[list->count - 1], 0, sizeof(Student));
-            list->count--;
-            return 1;
+    int i = student_list_slot_of_id(list, student_id);
+    if (i >= 0) {
+        // Leave a tombstone so no other record moves
+        student_list_unindex_student(list, i);
+        memset(student_list_at(list, i), 0, sizeof(Student));
+        student_list_at(list, i)->id = TOMBSTONE_ID;
+        if (!free_slots_push(&list->free_slots, i) ||
+            free_slots_should_compact(&list->free_slots, list->count)) {
+            student_list_compact(list);
         }
+        student_list_journal_note(list, STUDENT_JOURNAL_REMOVE, student_id, NULL);
+        return 1;
     }
 
     printf("Error: Student with ID %d not found\n", student_id);
     return 0;
 }
-Student* student_list_find_by_id(StudentList* list, int student_id) {
-    if (list == NULL || list->students == NULL) {
-        printf("Error: Invalid student list\n");
-        return NULL;
+// Squeeze tombstones out, keeping the live records in order. Records after
+// the first tombstone move, so pointers into the list are invalidated.
+void student_list_compact(StudentList* list) {
+    if (list == NULL) {
+        return;
     }
-    
+    int live = 0;
     for (int i = 0; i < list->count; i++) {
-        if (list->students[i].id == student_id) {
-            return &list->students[i];
+        if (!student_list_is_live(list, i)) {
+            continue;
         }
+        if (i != live) {
+            *student_list_at(list, live) = *student_list_at(list, i);
+        }
+        live++;
+    }
+    int moved = live != list->count;
+    list->count = live;
+    free_slots_clear(&list->free_slots);
+    segment_array_trim(&list->students, list->count);
+    if (moved) {
+        student_list_rebuild_indexes(list);
+    }
+}
+
+Student* student_list_find_by_id(StudentList* list, int student_id) {
+    if (list == NULL) {
+        printf("Error: Invalid student list\n");
+        return NULL;
     }
     
-    return NULL;
+    int slot = student_list_slot_of_id(list, student_id);
+    return slot >= 0 ? student_list_at(list, slot) : NULL;
 }
 Student* student_list_find_by_name(StudentList* list, const char* first_name, const char* last_name) {
-    if (list == NULL || list->students == NULL) {
+    if (list == NULL) {
         printf("Error: Invalid student list\n");
         return NULL;
     }
@@ -118,17 +397,23 @@ Student* student_list_find_by_name(StudentList* list, const char* first_name, co
         return NULL;
     }
 
-    for (int i = 0; i < list->count; i++) {
-        if (strcmp(list->students[i].first_name, first_name) == 0 && 
-            strcmp(list->students[i].last_name, last_name) == 0) {
-            return &list->students[i];
+    // Names match case-insensitively; keep returning the earliest match
+    int found = -1;
+    HashIndexProbe probe;
+    int slot;
+    hash_index_probe_begin(&list->name_index, student_name_hash(first_name, last_name), &probe);
+    while ((slot = hash_index_probe_next(&probe)) >= 0) {
+        if (slot < list->count && (found < 0 || slot < found) &&
+            student_equals_normalized(student_list_at(list, slot)->last_name, last_name) &&
+            student_equals_normalized(student_list_at(list, slot)->first_name, first_name)) {
+            found = slot;
         }
     }
     
-    return NULL;
+    return found >= 0 ? student_list_at(list, found) : NULL;
 }
 Student* student_list_find_by_email(StudentList* list, const char* email) {
-    if (list == NULL || list->students == NULL) {
+    if (list == NULL) {
         printf("Error: Invalid student list\n");
         return NULL;
     }
@@ -143,32 +428,78 @@ Student* student_list_find_by_email(StudentList* list, const char* email) {
         return NULL;
     }
 
-    for (int i = 0; i < list->count; i++) {
-        if (strcmp(list->students[i].email, email) == 0) {
-            return &list->students[i];
+    // Emails match case-insensitively; keep returning the earliest match
+    int found = -1;
+    HashIndexProbe probe;
+    int slot;
+    hash_index_probe_begin(&list->email_index, student_hash_normalized(email), &probe);
+    while ((slot = hash_index_probe_next(&probe)) >= 0) {
+        if (slot < list->count && (found < 0 || slot < found) &&
+            student_equals_normalized(student_list_at(list, slot)->email, email)) {
+            found = slot;
         }
     }
 
-    return NULL;
+    return found >= 0 ? student_list_at(list, found) : NULL;
+}
+// Replace a student's record and keep the lookup indexes in sync
+int student_list_update(StudentList* list, int student_id, Student updated) {
+    if (list == NULL) {
+        printf("Error: Invalid student list\n");
+        return 0;
+    }
+
+    int slot = student_list_slot_of_id(list, student_id);
+    if (slot < 0) {
+        printf("Error: Student with ID %d not found\n", student_id);
+        return 0;
+    }
+
+    student_list_unindex_student(list, slot);
+    *student_list_at(list, slot) = updated;
+    if (!student_list_index_student(list, slot)) {
+        printf("Error: Failed to index student %d\n", updated.id);
+        return 0;
+    }
+    student_list_journal_note(list, STUDENT_JOURNAL_UPDATE, student_id, &updated);
+    return 1;
+}
+
+// Interactive edit that goes through student_list_update
+int student_list_edit(StudentList* list, int student_id) {
+    Student* current = student_list_find_by_id(list, student_id);
+    if (current == NULL) {
+        printf("Error: Student with ID %d not found\n", student_id);
+        return 0;
+    }
+
+    Student edited = *current;
+    student_input_edit(&edited);
+    return student_list_update(list, student_id, edited);
 }
 void student_list_display_all(StudentList* list){
-    if (list == NULL || list->students == NULL) {
+    if (list == NULL) {
        printf("Error: Invalid student list\n");
        return;
     }
-    if(list->count==0){
+    if(student_list_get_count(list)==0){
        printf("LIST IS EMPTY \n");
        return;
     }
+    int shown = 0;
     for(int i = 0; i < list->count; i++) {
-       printf("\nStudent %d:\n", i + 1);
-       printf("ID: %d\n", list->students[i].id);
-       printf("First Name: %s\n", list->students[i].first_name);
-       printf("Last Name: %s\n", list->students[i].last_name);
-       printf("Email: %s\n", list->students[i].email);
-       printf("age: %d\n", list->students[i].age);
-       printf("Phone: %s\n", list->students[i].phone);
-       printf("Address: %s\n", list->students[i].address);
+       if (!student_list_is_live(list, i)) {
+           continue;
+       }
+       Student* s = student_list_at(list, i);
+       printf("\nStudent %d:\n", ++shown);
+       printf("ID: %d\n", s->id);
+       printf("First Name: %s\n", s->first_name);
+       printf("Last Name: %s\n", s->last_name);
+       printf("Email: %s\n", s->email);
+       printf("age: %d\n", s->age);
+       printf("Phone: %s\n", s->phone);
+       printf("Address: %s\n", s->address);
        printf("--------------------\n");
     }
 }
@@ -190,7 +521,7 @@ void student_list_display_student(Student* student) {
 
 
 int student_list_save_to_file(StudentList* list, const char* filename) {
-    if (list == NULL || list->students == NULL || filename == NULL) {
+    if (list == NULL || filename == NULL) {
         printf("Error: Invalid arguments to student_list_save_to_file\n");
         return 0;
     }
@@ -201,7 +532,10 @@ int student_list_save_to_file(StudentList* list, const char* filename) {
     }
     // Save students as CSV (or adjust fields as necessary)
     for (int i = 0; i < list->count; i++) {
-        Student* s = &list->students[i];
+        if (!student_list_is_live(list, i)) {
+            continue;
+        }
+        Student* s = student_list_at(list, i);
         fprintf(file, "%d,%s,%s,%s,%s,%s,%d,%s,%d,%.2f,%lld,%d\n",
             s->id,
             s->first_name,
@@ -220,127 +554,899 @@ int student_list_save_to_file(StudentList* list, const char* filename) {
     fclose(file);
     return 1;
 }
+// Copy a CSV field into a fixed-size buffer, returning 0 if it was cut short
+static int student_csv_copy(char* dest, size_t size, const char* field, const char* end) {
+    size_t length = (size_t)(end - field);
+    int fits = length < size;
+    if (!fits) {
+        length = size - 1;
+    }
+    memcpy(dest, field, length);
+    dest[length] = '\0';
+    return fits;
+}
+
+// Numeric fields may carry surrounding blanks, as sscanf accepted them
+static void student_csv_trim(const char** field, const char** end) {
+    while (*field < *end && isspace((unsigned char)**field)) {
+        (*field)++;
+    }
+    while (*end > *field && isspace((unsigned char)(*end)[-1])) {
+        (*end)--;
+    }
+}
+
+static int student_csv_parse_long(const char* p, const char* end, long long* out) {
+    int negative = 0;
+    long long value = 0;
+    student_csv_trim(&p, &end);
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+    // Up to 18 digits always fit in a long long
+    if (p == end || end - p > 18) {
+        return 0;
+    }
+    for (; p < end; p++) {
+        if (*p < '0' || *p > '9') {
+            return 0;
+        }
+        value = value * 10 + (*p - '0');
+    }
+    *out = negative ? -value : value;
+    return 1;
+}
+
+static int student_csv_parse_int(const char* p, const char* end, int* out) {
+    long long value;
+    if (!student_csv_parse_long(p, end, &value) || value < INT_MIN || value > INT_MAX) {
+        return 0;
+    }
+    *out = (int)value;
+    return 1;
+}
+
+// Plain decimal notation, as written by student_list_save_to_file
+static int student_csv_parse_float(const char* p, const char* end, float* out) {
+    static const double scale[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+    int negative = 0;
+    int digits = 0;
+    double value = 0.0;
+    student_csv_trim(&p, &end);
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+        value = value * 10.0 + (*p - '0');
+        digits++;
+    }
+    if (p < end && *p == '.') {
+        long long fraction = 0;
+        int fraction_digits = 0;
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++) {
+            // Digits beyond float precision are validated but ignored
+            if (fraction_digits < 9) {
+                fraction = fraction * 10 + (*p - '0');
+                fraction_digits++;
+            }
+            digits++;
+        }
+        value += (double)fraction / scale[fraction_digits];
+    }
+    if (p != end || digits == 0) {
+        return 0;
+    }
+    *out = (float)(negative ? -value : value);
+    return 1;
+}
+
+static const char* student_csv_rfind_comma(const char* start, const char* end) {
+    while (end > start) {
+        end--;
+        if (*end == ',') {
+            return end;
+        }
+    }
+    return NULL;
+}
+
+// Parse one CSV row straight into *s.
+// Returns NULL on success, otherwise a description of what is wrong.
+static const char* student_csv_parse_row(const char* line, const char* end, Student* s, int* truncated) {
+    const char* start[12];
+    const char* stop[12];
+    const char* p = line;
+    const char* q = end;
+
+    // The five leading and six trailing fields are comma-free, so the
+    // address in between may contain commas of its own
+    for (int k = 0; k < 5; k++) {
+        const char* comma = (const char*)memchr(p, ',', (size_t)(end - p));
+        if (comma == NULL) {
+            return "expected 12 comma-separated fields";
+        }
+        start[k] = p;
+        stop[k] = comma;
+        p = comma + 1;
+    }
+    for (int k = 11; k > 5; k--) {
+        const char* comma = student_csv_rfind_comma(p, q);
+        if (comma == NULL) {
+            return "expected 12 comma-separated fields";
+        }
+        start[k] = comma + 1;
+        stop[k] = q;
+        q = comma;
+    }
+    start[5] = p;
+    stop[5] = q;
+
+    long long enrollment_date;
+    if (!student_csv_parse_int(start[0], stop[0], &s->id)) return "invalid id";
+    if (!student_csv_parse_int(start[6], stop[6], &s->age)) return "invalid age";
+    if (!student_csv_parse_int(start[8], stop[8], &s->year)) return "invalid year";
+    if (!student_csv_parse_float(start[9], stop[9], &s->gpa)) return "invalid GPA";
+    if (!student_csv_parse_long(start[10], stop[10], &enrollment_date)) return "invalid enrollment date";
+    if (!student_csv_parse_int(start[11], stop[11], &s->is_active)) return "invalid active flag";
+    s->enrollment_date = (time_t)enrollment_date;
+
+    int fits = student_csv_copy(s->first_name, sizeof(s->first_name), start[1], stop[1]);
+    fits &= student_csv_copy(s->last_name, sizeof(s->last_name), start[2], stop[2]);
+    fits &= student_csv_copy(s->email, sizeof(s->email), start[3], stop[3]);
+    fits &= student_csv_copy(s->phone, sizeof(s->phone), start[4], stop[4]);
+    fits &= student_csv_copy(s->address, sizeof(s->address), start[5], stop[5]);
+    fits &= student_csv_copy(s->course, sizeof(s->course), start[7], stop[7]);
+    *truncated = !fits;
+    return NULL;
+}
+
 int student_list_load_from_file(StudentList* list, const char* filename){
     if (list == NULL || filename == NULL) {
         printf("Error: Invalid arguments to student_list_load_from_file\n");
         return 0;
     }
-    if (list->students == NULL) {
-        printf("Error: Student list students array is not allocated\n");
+    UtilsMappedFile mapped;
+    if (!utils_file_map(filename, &mapped)) {
+        printf("Error: Could not open file %s for reading\n", filename);
         return 0;
     }
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        printf("Error: Could not open file %s for reading\n", filename);
+    const char* data = mapped.data;
+    const char* data_end = mapped.data + mapped.size;
+
+    // Count the rows first so storage is sized from the file in one go
+    int rows = 0;
+    for (const char* p = data; p < data_end; rows++) {
+        const char* newline = (const char*)memchr(p, '\n', (size_t)(data_end - p));
+        p = newline ? newline + 1 : data_end;
+    }
+    if (!segment_array_reserve(&list->students, rows)) {
+        printf("Error: Unable to allocate more memory for students\n");
+        utils_file_unmap(&mapped);
         return 0;
     }
 
-    // We'll read each line and parse it into student fields
-    char line[512];
+    // Rows are parsed in place, straight into their final slot
     int index = 0;
-    while (fgets(line, sizeof(line), file)) {
-        Student s;
-        // Adjust sscanf format string to match the fields written in save_to_file
-        long long enrollment_date_temp;
-        int fields = sscanf(line, "%d,%[^,],%[^,],%[^,],%[^,],%[^,],%d,%[^,],%d,%f,%lld,%d",
-            &s.id,
-            s.first_name,
-            s.last_name,
-            s.email,
-            s.phone,
-            s.address,
-            &s.age,
-            s.course,
-            &s.year,
-            &s.gpa,
-            &enrollment_date_temp,
-            &s.is_active
-        );
-        // 12 fields expected
-        if (fields == 12) {
-            s.enrollment_date = (time_t)enrollment_date_temp;
-            if (index < list->capacity) {
-                list->students[index++] = s;
-            } else {
-                // Reallocate if necessary
-                int new_capacity = list->capacity ? list->capacity * 2 : 16;
-                Student *new_students = realloc(list->students, sizeof(Student) * new_capacity);
-                if (!new_students) {
-                    printf("Error: Unable to allocate more memory for students\n");
-                    fclose(file);
-                    return 0;
-                }
-                list->students = new_students;
-                list->capacity = new_capacity;
-                list->students[index++] = s;
+    int line_number = 0;
+    int rejected = 0;
+    const char* p = data;
+    while (p < data_end) {
+        const char* newline = (const char*)memchr(p, '\n', (size_t)(data_end - p));
+        const char* line_end = newline ? newline : data_end;
+        const char* next = newline ? newline + 1 : data_end;
+        line_number++;
+        if (line_end > p && line_end[-1] == '\r') {
+            line_end--;
+        }
+        if (line_end == p) {
+            p = next;
+            continue;
+        }
+
+        int truncated = 0;
+        const char* problem = student_csv_parse_row(p, line_end, student_list_at(list, index), &truncated);
+        if (problem != NULL) {
+            printf("Warning: %s line %d skipped: %s\n", filename, line_number, problem);
+            rejected++;
+        } else {
+            if (truncated) {
+                printf("Warning: %s line %d: over-long text field truncated\n", filename, line_number);
             }
+            index++;
         }
+        p = next;
     }
+    utils_file_unmap(&mapped);
+
     list->count = index;
-    fclose(file);
+    free_slots_clear(&list->free_slots);
+    segment_array_trim(&list->students, list->count);
+    if (rejected > 0) {
+        printf("Warning: %d row(s) of %s could not be loaded\n", rejected, filename);
+    }
+    if (!student_list_rebuild_indexes(list)) {
+        printf("Error: Unable to index students loaded from %s\n", filename);
+        return 0;
+    }
+    // Replaced wholesale, so the journal no longer describes the contents
+    list->journal_needs_compaction = 1;
+    list->dirty_generation++;
     return 1;
 }
-void student_list_sort_by_name(StudentList* list) {
-    if (list == NULL || list->students == NULL) {
-        printf("Error: Invalid student list\n");
+#define STUDENT_SNAPSHOT_BYTE_ORDER 0x01020304u
+
+int student_list_save_snapshot(StudentList* list, const char* filename) {
+    if (list == NULL || filename == NULL) {
+        printf("Error: Invalid arguments to student_list_save_snapshot\n");
+        return 0;
+    }
+    StudentSnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, STUDENT_SNAPSHOT_MAGIC, sizeof(STUDENT_SNAPSHOT_MAGIC));
+    header.byte_order = STUDENT_SNAPSHOT_BYTE_ORDER;
+    header.version = STUDENT_SNAPSHOT_VERSION;
+    header.record_size = (unsigned int)sizeof(Student);
+    header.count = (unsigned int)student_list_get_count(list);
+    // Adler-32 chains, so summing run by run equals one pass over the file body.
+    // Runs are live records that are contiguous in memory; tombstones are skipped.
+    header.checksum = 1;
+    for (int i = 0, run; i < list->count; i += run > 0 ? run : 1) {
+        run = student_list_live_run(list, i);
+        header.checksum = utils_hash_adler32(header.checksum, student_list_at(list, i), sizeof(Student) * (size_t)run);
+    }
+
+    FILE* file = fopen(filename, "wb");
+    if (!file) {
+        printf("Error: Could not open file %s for writing\n", filename);
+        return 0;
+    }
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int i = 0, run; ok && i < list->count; i += run > 0 ? run : 1) {
+        run = student_list_live_run(list, i);
+        ok = fwrite(student_list_at(list, i), sizeof(Student), (size_t)run, file) == (size_t)run;
+    }
+    if (fclose(file) != 0) {
+        ok = 0;
+    }
+    if (!ok) {
+        printf("Error: Could not write snapshot %s\n", filename);
+        // A partial snapshot would only be rejected on load; drop it now
+        remove(filename);
+        return 0;
+    }
+    return 1;
+}
+
+int student_list_load_snapshot(StudentList* list, const char* filename) {
+    if (list == NULL || filename == NULL) {
+        printf("Error: Invalid arguments to student_list_load_snapshot\n");
+        return 0;
+    }
+    UtilsMappedFile mapped;
+    if (!utils_file_map(filename, &mapped)) {
+        return 0;
+    }
+
+    // Anything that was not written by this build is rejected, never patched up
+    StudentSnapshotHeader header;
+    const char* problem = NULL;
+    size_t records_size = 0;
+    if (mapped.size < sizeof(header)) {
+        problem = "file too short";
+    } else {
+        memcpy(&header, mapped.data, sizeof(header));
+        records_size = sizeof(Student) * (size_t)header.count;
+        if (memcmp(header.magic, STUDENT_SNAPSHOT_MAGIC, sizeof(STUDENT_SNAPSHOT_MAGIC)) != 0) {
+            problem = "not a student snapshot";
+        } else if (header.byte_order != STUDENT_SNAPSHOT_BYTE_ORDER) {
+            problem = "written on a machine with a different byte order";
+        } else if (header.version != STUDENT_SNAPSHOT_VERSION) {
+            problem = "unsupported version";
+        } else if (header.record_size != sizeof(Student)) {
+            problem = "record size does not match this build";
+        } else if (header.count > (unsigned int)INT_MAX ||
+                   mapped.size - sizeof(header) != records_size) {
+            problem = "record count does not match file size";
+        } else if (utils_hash_adler32(1, mapped.data + sizeof(header), records_size) != header.checksum) {
+            problem = "checksum mismatch";
+        }
+    }
+    if (problem != NULL) {
+        printf("Warning: snapshot %s ignored: %s\n", filename, problem);
+        utils_file_unmap(&mapped);
+        return 0;
+    }
+
+    int count = (int)header.count;
+    if (!segment_array_reserve(&list->students, count)) {
+        printf("Error: Unable to allocate more memory for students\n");
+        utils_file_unmap(&mapped);
+        return 0;
+    }
+    // One memcpy per storage segment
+    const char* records = mapped.data + sizeof(header);
+    for (int i = 0, span; i < count; i += span) {
+        span = segment_array_span(i, count - i);
+        memcpy(student_list_at(list, i), records + sizeof(Student) * (size_t)i, sizeof(Student) * (size_t)span);
+    }
+    utils_file_unmap(&mapped);
+    list->count = count;
+    free_slots_clear(&list->free_slots);
+    segment_array_trim(&list->students, list->count);
+
+    if (!student_list_rebuild_indexes(list)) {
+        printf("Error: Unable to index students loaded from %s\n", filename);
+        return 0;
+    }
+    // As with a text load, pending journal records no longer apply
+    list->journal_needs_compaction = 1;
+    list->dirty_generation++;
+    return 1;
+}
+
+// Snapshot kept next to the list's text file
+static int student_list_snapshot_path(const StudentList* list, char* path, size_t size) {
+    int written = snprintf(path, size, "%s%s", list->filename, STUDENT_SNAPSHOT_SUFFIX);
+    return written > 0 && (size_t)written < size;
+}
+
+// Refresh the snapshot after the text file was saved; failure only costs a slower next load
+static void student_list_refresh_snapshot(StudentList* list) {
+    char path[sizeof(list->filename) + sizeof(STUDENT_SNAPSHOT_SUFFIX)];
+    if (student_list_snapshot_path(list, path, sizeof(path))) {
+        student_list_save_snapshot(list, path);
+    }
+}
+
+// Load from the snapshot if it is at least as new as the text file
+static int student_list_try_load_snapshot(StudentList* list) {
+    char path[sizeof(list->filename) + sizeof(STUDENT_SNAPSHOT_SUFFIX)];
+    if (!student_list_snapshot_path(list, path, sizeof(path))) {
+        return 0;
+    }
+    time_t snapshot_time = utils_file_get_modified_time(path);
+    if (snapshot_time == 0 || snapshot_time < utils_file_get_modified_time(list->filename)) {
+        return 0;
+    }
+    return student_list_load_snapshot(list, path);
+}
+
+// Journal kept next to the list's text file
+static int student_list_journal_path(const StudentList* list, char* path, size_t size) {
+    int written = snprintf(path, size, "%s%s", list->filename, STUDENT_JOURNAL_SUFFIX);
+    return written > 0 && (size_t)written < size;
+}
+
+// Size and modification time identify the text file a journal was started against
+static int student_list_file_stamp(const char* filename, long long* size, time_t* modified) {
+    long file_size = utils_file_get_size(filename);
+    if (file_size < 0) {
+        return 0;
+    }
+    *size = file_size;
+    *modified = utils_file_get_modified_time(filename);
+    return 1;
+}
+
+// Apply the journal on top of the freshly loaded text file or snapshot.
+// A journal started against another version of the text file is ignored.
+static void student_list_journal_replay(StudentList* list) {
+    list->journal_pending_count = 0;
+    list->journal_records = 0;
+    list->journal_needs_compaction = 0;
+    if (!student_list_file_stamp(list->filename, &list->journal_base_size, &list->journal_base_time)) {
+        list->journal_needs_compaction = 1;
         return;
     }
-    // Simple bubble sort by last_name, then first_name if last names equal
-    for (int i = 0; i < list->count - 1; i++) {
-        for (int j = 0; j < list->count - 1 - i; j++) {
-            int cmp = strcmp(list->students[j].last_name, list->students[j + 1].last_name);
-            if (cmp > 0 || (cmp == 0 && strcmp(list->students[j].first_name, list->students[j + 1].first_name) > 0)) {
-                Student temp = list->students[j];
-                list->students[j] = list->students[j + 1];
-                list->students[j + 1] = temp;
-            }
+
+    char path[sizeof(list->filename) + sizeof(STUDENT_JOURNAL_SUFFIX)];
+    UtilsMappedFile mapped;
+    if (!student_list_journal_path(list, path, sizeof(path)) || !utils_file_map(path, &mapped)) {
+        return;
+    }
+    StudentJournalHeader header;
+    const char* problem = NULL;
+    if (mapped.size < sizeof(header)) {
+        problem = "file too short";
+    } else {
+        memcpy(&header, mapped.data, sizeof(header));
+        if (memcmp(header.magic, STUDENT_JOURNAL_MAGIC, sizeof(STUDENT_JOURNAL_MAGIC)) != 0 ||
+            header.byte_order != STUDENT_SNAPSHOT_BYTE_ORDER ||
+            header.version != STUDENT_JOURNAL_VERSION ||
+            header.record_size != sizeof(StudentJournalRecord)) {
+            problem = "not written by this build";
         }
     }
+    if (problem != NULL) {
+        printf("Warning: journal %s ignored: %s\n", path, problem);
+        utils_file_unmap(&mapped);
+        return;
+    }
+    if (header.base_size != list->journal_base_size || header.base_time != (long long)list->journal_base_time) {
+        // Already folded into the text file by an interrupted compaction
+        utils_file_unmap(&mapped);
+        return;
+    }
+
+    const char* p = mapped.data + sizeof(header);
+    const char* end = mapped.data + mapped.size;
+    int applied = 0;
+    while ((size_t)(end - p) >= sizeof(StudentJournalRecord)) {
+        StudentJournalRecord record;
+        memcpy(&record, p, sizeof(record));
+        unsigned int checksum = record.checksum;
+        record.checksum = 0;
+        if (utils_hash_adler32(1, &record, sizeof(record)) != checksum) {
+            break;
+        }
+        if (record.op == STUDENT_JOURNAL_ADD) {
+            student_list_add(list, record.student);
+        } else if (record.op == STUDENT_JOURNAL_UPDATE) {
+            student_list_update(list, record.student_id, record.student);
+        } else if (record.op == STUDENT_JOURNAL_REMOVE) {
+            student_list_remove(list, record.student_id);
+        } else {
+            break;
+        }
+        applied++;
+        p += sizeof(record);
+    }
+    if (p != end) {
+        // Torn or corrupt tail: keep what was valid and rewrite everything on the next save
+        printf("Warning: journal %s damaged after record %d; later changes dropped\n", path, applied);
+        list->journal_needs_compaction = 1;
+    }
+    list->journal_records = applied;
+    utils_file_unmap(&mapped);
 }
 
-// Sort students by ID in ascending order
-void student_list_sort_by_id(StudentList* list) {
-    if (list == NULL || list->students == NULL || list->count < 2) return;
-    for (int i = 0; i < list->count - 1; i++) {
-        for (int j = 0; j < list->count - i - 1; j++) {
-            if (list->students[j].id > list->students[j + 1].id) {
-                Student temp = list->students[j];
-                list->students[j] = list->students[j + 1];
-                list->students[j + 1] = temp;
-            }
+// Write a fresh journal containing only the header for the current text file
+static int student_list_journal_start(StudentList* list, const char* path, const char* mode) {
+    StudentJournalHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, STUDENT_JOURNAL_MAGIC, sizeof(STUDENT_JOURNAL_MAGIC));
+    header.byte_order = STUDENT_SNAPSHOT_BYTE_ORDER;
+    header.version = STUDENT_JOURNAL_VERSION;
+    header.record_size = (unsigned int)sizeof(StudentJournalRecord);
+    header.base_size = list->journal_base_size;
+    header.base_time = (long long)list->journal_base_time;
+
+    FILE* file = fopen(path, mode);
+    if (!file) {
+        return 0;
+    }
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    if (fclose(file) != 0) {
+        ok = 0;
+    }
+    return ok;
+}
+
+// Rewrite the text file and snapshot, then empty the journal
+static int student_list_journal_compact(StudentList* list) {
+    if (student_list_save_to_file(list, list->filename) == 0) {
+        return 0;
+    }
+    student_list_refresh_snapshot(list);
+    list->journal_pending_count = 0;
+    list->journal_records = 0;
+    list->journal_needs_compaction = 1;
+
+    char path[sizeof(list->filename) + sizeof(STUDENT_JOURNAL_SUFFIX)];
+    if (student_list_file_stamp(list->filename, &list->journal_base_size, &list->journal_base_time) &&
+        student_list_journal_path(list, path, sizeof(path)) &&
+        student_list_journal_start(list, path, "wb")) {
+        list->journal_needs_compaction = 0;
+    }
+    return 1;
+}
+
+// Append the pending records to a journal that is known to be intact
+static int student_list_journal_append(StudentList* list) {
+    char path[sizeof(list->filename) + sizeof(STUDENT_JOURNAL_SUFFIX)];
+    if (!student_list_journal_path(list, path, sizeof(path))) {
+        return 0;
+    }
+    if (list->journal_records == 0) {
+        // Nothing worth keeping yet: (re)start the journal against the current text file
+        if (!student_list_journal_start(list, path, "wb")) {
+            return 0;
         }
+    } else {
+        long expected = (long)(sizeof(StudentJournalHeader) +
+                               sizeof(StudentJournalRecord) * (size_t)list->journal_records);
+        if (utils_file_get_size(path) != expected) {
+            return 0;
+        }
+    }
+
+    FILE* file = fopen(path, "ab");
+    if (!file) {
+        return 0;
+    }
+    size_t pending = (size_t)list->journal_pending_count;
+    int ok = fwrite(list->journal_pending, sizeof(StudentJournalRecord), pending, file) == pending;
+    if (fclose(file) != 0) {
+        ok = 0;
     }
+    if (ok) {
+        list->journal_records += list->journal_pending_count;
+        list->journal_pending_count = 0;
+    }
+    return ok;
 }
 
-// Sort students by GPA in descending order
-void student_list_sort_by_gpa(StudentList* list) {
-    if (list == NULL || list->students == NULL || list->count < 2) return;
-    for (int i = 0; i < list->count - 1; i++) {
-        for (int j = 0; j < list->count - i - 1; j++) {
-            if (list->students[j].gpa < list->students[j + 1].gpa) {
-                Student temp = list->students[j];
-                list->students[j] = list->students[j + 1];
-                list->students[j + 1] = temp;
-            }
+// Persist the list to its file: append to the journal when that is safe,
+// otherwise (or once the journal outgrows the roster) compact
+static int student_list_persist(StudentList* list) {
+    long long size;
+    time_t modified;
+    int total = list->journal_records + list->journal_pending_count;
+    if (list->journal_needs_compaction ||
+        !student_list_file_stamp(list->filename, &size, &modified) ||
+        size != list->journal_base_size || modified != list->journal_base_time ||
+        total > list->count / 2 + STUDENT_JOURNAL_COMPACT_SLACK) {
+        return student_list_journal_compact(list);
+    }
+    if (list->journal_pending_count == 0) {
+        return 1;
+    }
+    if (!student_list_journal_append(list)) {
+        return student_list_journal_compact(list);
+    }
+    return 1;
+}
+
+// Last name, then first name, as plain strcmp ordering
+static int student_compare_names(int a, int b, const void* context) {
+    const StudentList* list = (const StudentList*)context;
+    const Student* first = student_list_at(list, a);
+    const Student* second = student_list_at(list, b);
+    int cmp = strcmp(first->last_name, second->last_name);
+    if (cmp != 0) {
+        return cmp;
+    }
+    return strcmp(first->first_name, second->first_name);
+}
+
+// Fill order with the positions of the live students sorted by key, without
+// moving records; order needs room for list->count entries and receives
+// student_list_get_count of them. Ties keep their current relative order.
+int student_list_sorted_view(StudentList* list, StudentSortKey key, int* order) {
+    if (list == NULL || order == NULL) {
+        printf("Error: Invalid arguments to student_list_sorted_view\n");
+        return 0;
+    }
+    // Tombstoned slots are left out rather than compacted away
+    int live = 0;
+    for (int i = 0; i < list->count; i++) {
+        if (student_list_is_live(list, i)) {
+            order[live++] = i;
         }
     }
+    if (live < 2) {
+        return 1;
+    }
+
+    if (key == STUDENT_SORT_BY_NAME) {
+        return sort_merge_indices(order, live, student_compare_names, list);
+    }
+
+    unsigned int* keys = (unsigned int*)malloc(sizeof(unsigned int) * list->count);
+    if (keys == NULL) {
+        printf("Error: Failed to allocate memory for sort keys\n");
+        return 0;
+    }
+    for (int i = 0; i < live; i++) {
+        Student* s = student_list_at(list, order[i]);
+        if (key == STUDENT_SORT_BY_ID) {
+            keys[order[i]] = sort_key_from_int(s->id);
+        } else {
+            // Inverted so that the highest GPA comes first
+            keys[order[i]] = ~sort_key_from_float(s->gpa);
+        }
+    }
+    int result = sort_radix_indices(keys, order, live);
+    free(keys);
+    return result;
 }
 
+static void* student_list_element(int index, void* context) {
+    return student_list_at((StudentList*)context, index);
+}
+
+// Sort the records themselves: each one is moved once, then re-indexed.
+// Records move anyway, so the tombstones are squeezed out first.
+static void student_list_sort(StudentList* list, StudentSortKey key) {
+    if (list == NULL) {
+        printf("Error: Invalid student list\n");
+        return;
+    }
+    student_list_compact(list);
+    if (list->count < 2) {
+        return;
+    }
+
+    int* order = (int*)malloc(sizeof(int) * list->count);
+    if (order == NULL) {
+        printf("Error: Failed to allocate memory for sorting\n");
+        return;
+    }
+    if (student_list_sorted_view(list, key, order)) {
+        sort_apply_permutation_at(student_list_element, list, sizeof(Student), order, list->count);
+        student_list_rebuild_indexes(list);
+        // Journal records keep no order, so the next save rewrites the file
+        list->journal_needs_compaction = 1;
+        list->dirty_generation++;
+    }
+    free(order);
+}
+
+// Sort students by last name, then first name
+void student_list_sort_by_name(StudentList* list) {
+    student_list_sort(list, STUDENT_SORT_BY_NAME);
+}
+
+// Sort students by ID in ascending order
+void student_list_sort_by_id(StudentList* list) {
+    student_list_sort(list, STUDENT_SORT_BY_ID);
+}
+
+// Sort students by GPA in descending order
+void student_list_sort_by_gpa(StudentList* list) {
+    student_list_sort(list, STUDENT_SORT_BY_GPA);
+}
+
+// Live records; tombstones are not counted
 int student_list_get_count(StudentList* list) {
     if (list == NULL) return 0;
-    return list->count;
+    return list->count - list->free_slots.count;
 }
+// Record at slot index, below list->count. A deleted record's slot gives
+// NULL; nothing is moved, so pointers from the find functions stay valid.
 Student* student_list_get_student(StudentList* list, int index){
-    if(list == NULL || list->students == NULL){
+    if(list == NULL){
         return NULL;
     }
     // Is true if index is in valid range
-    if(index >= 0 && index < list->count) {
-        return &list->students[index];
+    if(index >= 0 && index < list->count && student_list_is_live(list, index)) {
+        return student_list_at(list, index);
     } else {
         return NULL;
     }
 }
+// A single writer thread per list. The UI thread hands it a private copy of
+// the records and the pending journal records, so the list itself is never
+// touched off the UI thread; the writer hands back only journal bookkeeping.
+struct StudentAutoSaver {
+    GThread* thread;
+    GMutex lock;
+    GCond wake;             // Signals a queued job, a finished job or stopping
+    guint timer_id;
+    int stopping;
+    int busy;               // Writer is working on a job
+    StudentList* job;       // Copy waiting to be written
+    unsigned long job_generation;
+    // Outcome of the last finished job, applied by student_list_saver_collect
+    int has_result;
+    int result_ok;
+    unsigned long result_generation;
+    int result_journal_records;
+    int result_needs_compaction;
+    long long result_base_size;
+    time_t result_base_time;
+    time_t result_time;
+};
+
+static gpointer student_list_saver_run(gpointer data) {
+    StudentAutoSaver* saver = (StudentAutoSaver*)data;
+    g_mutex_lock(&saver->lock);
+    for (;;) {
+        while (saver->job == NULL && !saver->stopping) {
+            g_cond_wait(&saver->wake, &saver->lock);
+        }
+        // A queued job is still written when stopping
+        if (saver->job == NULL) {
+            break;
+        }
+        StudentList* job = saver->job;
+        unsigned long generation = saver->job_generation;
+        saver->job = NULL;
+        saver->busy = 1;
+        g_mutex_unlock(&saver->lock);
+
+        int ok = student_list_persist(job);
+
+        g_mutex_lock(&saver->lock);
+        saver->has_result = 1;
+        saver->result_ok = ok;
+        saver->result_generation = generation;
+        saver->result_journal_records = job->journal_records;
+        saver->result_needs_compaction = job->journal_needs_compaction;
+        saver->result_base_size = job->journal_base_size;
+        saver->result_base_time = job->journal_base_time;
+        saver->result_time = time(NULL);
+        saver->busy = 0;
+        g_cond_broadcast(&saver->wake);
+        student_list_destroy(job);
+    }
+    g_mutex_unlock(&saver->lock);
+    return NULL;
+}
+
+// Fold the last finished job back into the list. Caller holds saver->lock.
+static void student_list_saver_collect(StudentList* list) {
+    StudentAutoSaver* saver = list->auto_saver;
+    if (!saver->has_result) {
+        return;
+    }
+    saver->has_result = 0;
+    list->journal_records = saver->result_journal_records;
+    list->journal_base_size = saver->result_base_size;
+    list->journal_base_time = saver->result_base_time;
+    // A failed job lost its pending records, which only a full rewrite recovers
+    if (!saver->result_ok || saver->result_needs_compaction) {
+        list->journal_needs_compaction = 1;
+    }
+    if (saver->result_ok) {
+        if (saver->result_generation > list->saved_generation) {
+            list->saved_generation = saver->result_generation;
+        }
+        list->last_save_time = saver->result_time;
+    }
+}
+
+// Block until the writer is idle, so the caller may touch the files directly
+static void student_list_saver_wait(StudentList* list) {
+    StudentAutoSaver* saver = list->auto_saver;
+    if (saver == NULL) {
+        return;
+    }
+    g_mutex_lock(&saver->lock);
+    while (saver->job != NULL || saver->busy) {
+        g_cond_wait(&saver->wake, &saver->lock);
+    }
+    student_list_saver_collect(list);
+    g_mutex_unlock(&saver->lock);
+}
+
+// Private copy for the writer. The pending journal records move with it;
+// anything recorded after this point stays pending on the list.
+static StudentList* student_list_saver_copy(StudentList* list) {
+    StudentList* copy = (StudentList*)calloc(1, sizeof(StudentList));
+    if (copy == NULL) {
+        return NULL;
+    }
+    segment_array_init(&copy->students, sizeof(Student));
+    free_slots_init(&copy->free_slots);
+    if (!segment_array_reserve(&copy->students, student_list_get_count(list))) {
+        segment_array_free(&copy->students);
+        free(copy);
+        return NULL;
+    }
+    // The copy leaves the tombstones behind; the list itself is not compacted
+    // because the UI may hold pointers into it
+    for (int i = 0, run; i < list->count; i += run > 0 ? run : 1) {
+        run = student_list_live_run(list, i);
+        for (int done = 0, span; done < run; done += span) {
+            span = segment_array_span(copy->count, run - done);
+            memcpy(student_list_at(copy, copy->count), student_list_at(list, i + done), sizeof(Student) * (size_t)span);
+            copy->count += span;
+        }
+    }
+    copy->is_loaded = 1;
+    memcpy(copy->filename, list->filename, sizeof(copy->filename));
+    hash_index_init(&copy->id_index);
+    hash_index_init(&copy->email_index);
+    hash_index_init(&copy->name_index);
+
+    copy->journal_pending = list->journal_pending;
+    copy->journal_pending_count = list->journal_pending_count;
+    copy->journal_pending_capacity = list->journal_pending_capacity;
+    copy->journal_records = list->journal_records;
+    copy->journal_needs_compaction = list->journal_needs_compaction;
+    copy->journal_base_size = list->journal_base_size;
+    copy->journal_base_time = list->journal_base_time;
+    list->journal_pending = NULL;
+    list->journal_pending_count = 0;
+    list->journal_pending_capacity = 0;
+    list->journal_needs_compaction = 0;
+    return copy;
+}
+
+static gboolean student_list_saver_tick(gpointer data) {
+    student_list_auto_save_async((StudentList*)data);
+    return G_SOURCE_CONTINUE;
+}
+
+int student_list_is_dirty(StudentList* list) {
+    if (list == NULL) {
+        return 0;
+    }
+    return list->dirty_generation != list->saved_generation || list->journal_needs_compaction;
+}
+
+// Save off the UI thread every interval_seconds on the GLib main loop
+int student_list_start_auto_save(StudentList* list, unsigned int interval_seconds) {
+    if (list == NULL || interval_seconds == 0) {
+        printf("Error: Invalid arguments to student_list_start_auto_save\n");
+        return 0;
+    }
+    if (list->auto_saver != NULL) {
+        return 1;
+    }
+    StudentAutoSaver* saver = (StudentAutoSaver*)calloc(1, sizeof(StudentAutoSaver));
+    if (saver == NULL) {
+        printf("Error: Failed to allocate auto-saver\n");
+        return 0;
+    }
+    g_mutex_init(&saver->lock);
+    g_cond_init(&saver->wake);
+    saver->thread = g_thread_new("student-autosave", student_list_saver_run, saver);
+    list->auto_saver = saver;
+    saver->timer_id = g_timeout_add_seconds(interval_seconds, student_list_saver_tick, list);
+    return 1;
+}
+
+// Stop the timer and the writer; a save already queued still completes
+void student_list_stop_auto_save(StudentList* list) {
+    if (list == NULL || list->auto_saver == NULL) {
+        return;
+    }
+    StudentAutoSaver* saver = list->auto_saver;
+    if (saver->timer_id != 0) {
+        g_source_remove(saver->timer_id);
+    }
+    g_mutex_lock(&saver->lock);
+    saver->stopping = 1;
+    g_cond_broadcast(&saver->wake);
+    g_mutex_unlock(&saver->lock);
+    g_thread_join(saver->thread);
+
+    student_list_saver_collect(list);
+    g_cond_clear(&saver->wake);
+    g_mutex_clear(&saver->lock);
+    free(saver);
+    list->auto_saver = NULL;
+}
+
+// Queue a background save of the current contents if anything changed.
+// Returns immediately; while the previous save is still being written
+// nothing is queued and the next call picks the changes up.
+int student_list_auto_save_async(StudentList* list) {
+    if (list == NULL || list->auto_saver == NULL) {
+        return 0;
+    }
+    if (!list->auto_save_enabled || !list->is_loaded ||
+        list->filename[0] == '\0') {
+        return 0;
+    }
+    StudentAutoSaver* saver = list->auto_saver;
+    g_mutex_lock(&saver->lock);
+    student_list_saver_collect(list);
+    if (saver->job != NULL || saver->busy) {
+        g_mutex_unlock(&saver->lock);
+        return 0;
+    }
+    if (!student_list_is_dirty(list)) {
+        g_mutex_unlock(&saver->lock);
+        return 1;
+    }
+    StudentList* copy = student_list_saver_copy(list);
+    if (copy == NULL) {
+        g_mutex_unlock(&saver->lock);
+        printf("Error: Failed to copy students for background save\n");
+        return 0;
+    }
+    saver->job = copy;
+    saver->job_generation = list->dirty_generation;
+    g_cond_broadcast(&saver->wake);
+    g_mutex_unlock(&saver->lock);
+    return 1;
+}
+
 int student_list_ensure_loaded(StudentList* list){
     // Check for NULL pointer
     if (list == NULL) {
@@ -359,24 +1465,23 @@ int student_list_ensure_loaded(StudentList* list){
         return 0;
     }
     
-    // Ensure students array is allocated
-    if (list->students == NULL) {
-        list->students = (Student*)malloc(MAX_STUDENTS * sizeof(Student));
-        if (list->students == NULL) {
-            printf("Error: Failed to allocate memory for students array\n");
-            return 0;
-        }
-        list->capacity = MAX_STUDENTS;
-    }
-    
     // Reset count before loading to avoid appending to existing data
     list->count = 0;
+    free_slots_clear(&list->free_slots);
     
-    // Try to load data from file
-    if (student_list_load_from_file(list, list->filename) == 0) {
-        printf("Error: Failed to load student data from file: %s\n", list->filename);
-        return 0;
+    // Let a background save finish before reading the files it writes
+    student_list_saver_wait(list);
+    
+    // Prefer the binary snapshot; fall back to parsing the text file
+    if (!student_list_try_load_snapshot(list)) {
+        list->count = 0;
+        if (student_list_load_from_file(list, list->filename) == 0) {
+            printf("Error: Failed to load student data from file: %s\n", list->filename);
+            return 0;
+        }
     }
+    student_list_journal_replay(list);
+    list->saved_generation = list->dirty_generation;
     
     // Mark as loaded on success
     list->is_loaded = 1;
@@ -397,29 +1502,30 @@ int student_list_save_and_unload(StudentList* list){
     }
     
     // Check if data is loaded and has students to save
-    if (!list->is_loaded || list->students == NULL) {
+    if (!list->is_loaded) {
         printf("Error: No data loaded to save\n");
         return 0;
     }
 
-    // Save data to file
-    if (student_list_save_to_file(list, list->filename) == 0) {
+    // Save data to file, after any background save still in flight
+    student_list_saver_wait(list);
+    if (student_list_persist(list) == 0) {
         printf("Error: Failed to save student data to file: %s\n", list->filename);
         return 0;
     }
+    list->saved_generation = list->dirty_generation;
     
     // Update last save time
     list->last_save_time = time(NULL);
     
-    // Free the students array to unload from memory
-    if (list->students != NULL) {
-        free(list->students);
-        list->students = NULL;
-    }
+    // Free the student records to unload from memory
+    segment_array_free(&list->students);
     
-    // Reset count and capacity
+    // Reset count
     list->count = 0;
-    list->capacity = 0;
+    free_slots_free(&list->free_slots);
+    student_list_free_indexes(list);
+    student_list_journal_reset(list);
     
     // Mark as not loaded
     list->is_loaded = 0;
@@ -438,7 +1544,7 @@ int student_list_auto_save(StudentList* list){
     }
     
     // Check if data is loaded
-    if (!list->is_loaded || list->students == NULL) {
+    if (!list->is_loaded) {
         return 0;
     }
     
@@ -447,10 +1553,17 @@ int student_list_auto_save(StudentList* list){
         return 0;
     }
     
+    // Nothing changed since the last save
+    student_list_saver_wait(list);
+    if (!student_list_is_dirty(list)) {
+        return 1;
+    }
+    
     // Save data to file
-    if (student_list_save_to_file(list, list->filename) == 0) {
+    if (student_list_persist(list) == 0) {
         return 0;
     }
+    list->saved_generation = list->dirty_generation;
     
     // Update last save time
     list->last_save_time = time(NULL);
@@ -468,9 +1581,14 @@ void student_list_set_filename(StudentList* list, const char* filename){
         return;
     }
     
+    student_list_saver_wait(list);
     // Use strncpy to safely copy filename with size limit
     strncpy(list->filename, filename, sizeof(list->filename) - 1);
     list->filename[sizeof(list->filename) - 1] = '\0'; // Ensure null termination
+    // The journal belongs to the previous file
+    list->journal_pending_count = 0;
+    list->journal_needs_compaction = 1;
+    list->dirty_generation++;
 }
 int student_validate_gpa(float gpa) {
     if (gpa < 0.0 || gpa > 4.0) {
@@ -674,17 +1792,20 @@ void student_input_edit(Student* student) {
 }
 
 void student_display_summary(StudentList* list) {
-    if (!list || list->count == 0) {
+    if (!list || student_list_get_count(list) == 0) {
         printf("Aucun étudiant à afficher.\n");
         return;
     }
     printf("| ID  | Prenom          | Nom             | Email                   | Telephone     | GPA  | Age | Statut | Filiere        |\n");
     printf("--------------------------------------------------------------------------------------------------------------\n");
     for (int i = 0; i < list->count; i++) {
-        Student s = list->students[i];
+        if (!student_list_is_live(list, i)) {
+            continue;
+        }
+        Student s = *student_list_at(list, i);
         printf("| %-3d | %-15s | %-15s | %-22s | %-12s | %-4.2f | %-3d | %-6d | %-14s |\n",
                s.id, s.first_name, s.last_name, s.email, s.phone, s.gpa, s.age, s.is_active, s.course);
     }
     printf("--------------------------------------------------------------------------------------------------------------\n");
-    printf("Total: %d étudiant(s)\n", list->count);
+    printf("Total: %d étudiant(s)\n", student_list_get_count(list));
 }
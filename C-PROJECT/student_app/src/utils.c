@@ -17,6 +17,8 @@
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <pwd.h>
 #endif
 
@@ -356,44 +358,159 @@ time_t utils_date_create_with_time(int year, int month, int day, int hour, int m
     return mktime(&timeinfo);
 }
 
+// Civil dates are computed with integer arithmetic from the day number and
+// the local UTC offset. Offsets come from localtime_r/localtime_s once per UTC
+// day and are cached per thread, so workers never share state and the libc
+// timezone code runs only when a new day is seen. A day whose offset changes
+// part way (a DST switch) is never cached and always asks libc.
+#if defined(_MSC_VER)
+#define UTILS_THREAD_LOCAL __declspec(thread)
+#else
+#define UTILS_THREAD_LOCAL _Thread_local
+#endif
+
+#define UTILS_SECONDS_PER_DAY 86400
+#define UTILS_DATE_CACHE_SIZE 64   // Power of two
+
+typedef struct {
+    long long day;      // UTC day number
+    long offset;        // Local time minus UTC, in seconds
+    int valid;
+} UtilsOffsetCacheEntry;
+
+static UTILS_THREAD_LOCAL UtilsOffsetCacheEntry utils_offset_cache[UTILS_DATE_CACHE_SIZE];
+
+static long long utils_floor_div(long long a, long long b) {
+    long long q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+static long long utils_days_from_civil(long long year, int month, int day) {
+    year -= month <= 2;
+    long long era = (year >= 0 ? year : year - 399) / 400;
+    long long yoe = year - era * 400;
+    long long doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    long long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static void utils_civil_from_days(long long days, long long* year, int* month, int* day) {
+    days += 719468;
+    long long era = (days >= 0 ? days : days - 146096) / 146097;
+    long long doe = days - era * 146097;
+    long long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    long long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    long long mp = (5 * doy + 2) / 153;
+    *day = (int)(doy - (153 * mp + 2) / 5 + 1);
+    *month = (int)(mp < 10 ? mp + 3 : mp - 9);
+    *year = yoe + era * 400 + (*month <= 2);
+}
+
+// UTC offset in effect at date, straight from libc
+static int utils_local_offset(time_t date, long* offset) {
+    struct tm timeinfo;
+#if defined(_WIN32) || defined(_WIN64)
+    if (localtime_s(&timeinfo, &date) != 0) return 0;
+#else
+    if (localtime_r(&date, &timeinfo) == NULL) return 0;
+#endif
+    long long local = utils_days_from_civil(timeinfo.tm_year + 1900LL, timeinfo.tm_mon + 1, timeinfo.tm_mday) * UTILS_SECONDS_PER_DAY +
+                      timeinfo.tm_hour * 3600 + timeinfo.tm_min * 60 + timeinfo.tm_sec;
+    *offset = (long)(local - (long long)date);
+    return 1;
+}
+
+static int utils_cached_offset(time_t date, long* offset) {
+    long long day = utils_floor_div((long long)date, UTILS_SECONDS_PER_DAY);
+    UtilsOffsetCacheEntry* entry = &utils_offset_cache[(unsigned long long)day & (UTILS_DATE_CACHE_SIZE - 1)];
+    if (entry->valid && entry->day == day) {
+        *offset = entry->offset;
+        return 1;
+    }
+
+    long first;
+    long last;
+    time_t day_start = (time_t)(day * UTILS_SECONDS_PER_DAY);
+    if (!utils_local_offset(day_start, &first) ||
+        !utils_local_offset(day_start + UTILS_SECONDS_PER_DAY - 1, &last)) {
+        return utils_local_offset(date, offset);
+    }
+    if (first != last) {
+        return utils_local_offset(date, offset);
+    }
+    entry->day = day;
+    entry->offset = first;
+    entry->valid = 1;
+    *offset = first;
+    return 1;
+}
+
+// Fill civil with the local calendar fields of date; returns 1, or 0 if the
+// platform cannot represent it. Safe to call from any thread.
+int utils_date_civil(time_t date, UtilsCivilDate* civil) {
+    long offset;
+    if (!civil || !utils_cached_offset(date, &offset)) return 0;
+
+    long long local = (long long)date + offset;
+    long long days = utils_floor_div(local, UTILS_SECONDS_PER_DAY);
+    int seconds = (int)(local - days * UTILS_SECONDS_PER_DAY);
+    long long year;
+    utils_civil_from_days(days, &year, &civil->month, &civil->day);
+
+    civil->year = (int)year;
+    civil->hour = seconds / 3600;
+    civil->minute = seconds / 60 % 60;
+    civil->second = seconds % 60;
+    civil->day_of_week = (int)(days - utils_floor_div(days + 4, 7) * 7 + 4);
+    civil->day_of_year = (int)(days - utils_days_from_civil(year, 1, 1)) + 1;
+    return 1;
+}
+
+// Local calendar day of date as yyyymmdd, or 0 on failure
+int utils_date_day_key(time_t date) {
+    UtilsCivilDate civil;
+    return utils_date_civil(date, &civil) ? civil.year * 10000 + civil.month * 100 + civil.day : 0;
+}
+
 int utils_date_get_year(time_t date) {
-    struct tm* timeinfo = localtime(&date);
-    return timeinfo ? timeinfo->tm_year + 1900 : 0;
+    UtilsCivilDate civil;
+    return utils_date_civil(date, &civil) ? civil.year : 0;
 }
 
 int utils_date_get_month(time_t date) {
-    struct tm* timeinfo = localtime(&date);
-    return timeinfo ? timeinfo->tm_mon + 1 : 0;
+    UtilsCivilDate civil;
+    return utils_date_civil(date, &civil) ? civil.month : 0;
 }
 
 int utils_date_get_day(time_t date) {
-    struct tm* timeinfo = localtime(&date);
-    return timeinfo ? timeinfo->tm_mday : 0;
+    UtilsCivilDate civil;
+    return utils_date_civil(date, &civil) ? civil.day : 0;
 }
 
 int utils_date_get_hour(time_t date) {
-    struct tm* timeinfo = localtime(&date);
-    return timeinfo ? timeinfo->tm_hour : 0;
+    UtilsCivilDate civil;
+    return utils_date_civil(date, &civil) ? civil.hour : 0;
 }
 
 int utils_date_get_minute(time_t date) {
-    struct tm* timeinfo = localtime(&date);
-    return timeinfo ? timeinfo->tm_min : 0;
+    UtilsCivilDate civil;
+    return utils_date_civil(date, &civil) ? civil.minute : 0;
 }
 
 int utils_date_get_second(time_t date) {
-    struct tm* timeinfo = localtime(&date);
-    return timeinfo ? timeinfo->tm_sec : 0;
+    UtilsCivilDate civil;
+    return utils_date_civil(date, &civil) ? civil.second : 0;
 }
 
 int utils_date_get_day_of_week(time_t date) {
-    struct tm* timeinfo = localtime(&date);
-    return timeinfo ? timeinfo->tm_wday : 0;
+    UtilsCivilDate civil;
+    return utils_date_civil(date, &civil) ? civil.day_of_week : 0;
 }
 
 int utils_date_get_day_of_year(time_t date) {
-    struct tm* timeinfo = localtime(&date);
-    return timeinfo ? timeinfo->tm_yday + 1 : 0;
+    UtilsCivilDate civil;
+    return utils_date_civil(date, &civil) ? civil.day_of_year : 0;
 }
 
 int utils_date_is_leap_year(int year) {
@@ -416,40 +533,53 @@ time_t utils_date_add_days(time_t date, int days) {
     return date + (days * 24 * 60 * 60);
 }
 
+// Same wall-clock time on the shifted date, letting mktime pick the DST flag
+static time_t utils_date_from_civil(const UtilsCivilDate* civil) {
+    struct tm timeinfo = {0};
+    timeinfo.tm_year = civil->year - 1900;
+    timeinfo.tm_mon = civil->month - 1;
+    timeinfo.tm_mday = civil->day;
+    timeinfo.tm_hour = civil->hour;
+    timeinfo.tm_min = civil->minute;
+    timeinfo.tm_sec = civil->second;
+    timeinfo.tm_isdst = -1;
+    return mktime(&timeinfo);
+}
+
 time_t utils_date_add_months(time_t date, int months) {
-    struct tm* timeinfo = localtime(&date);
-    if (!timeinfo) return date;
+    UtilsCivilDate civil;
+    if (!utils_date_civil(date, &civil)) return date;
     
-    timeinfo->tm_mon += months;
-    while (timeinfo->tm_mon > 11) {
-        timeinfo->tm_mon -= 12;
-        timeinfo->tm_year++;
+    civil.month += months;
+    while (civil.month > 12) {
+        civil.month -= 12;
+        civil.year++;
     }
-    while (timeinfo->tm_mon < 0) {
-        timeinfo->tm_mon += 12;
-        timeinfo->tm_year--;
+    while (civil.month < 1) {
+        civil.month += 12;
+        civil.year--;
     }
     
-    int max_day = utils_date_days_in_month(timeinfo->tm_year + 1900, timeinfo->tm_mon + 1);
-    if (timeinfo->tm_mday > max_day) {
-        timeinfo->tm_mday = max_day;
+    int max_day = utils_date_days_in_month(civil.year, civil.month);
+    if (civil.day > max_day) {
+        civil.day = max_day;
     }
     
-    return mktime(timeinfo);
+    return utils_date_from_civil(&civil);
 }
 
 time_t utils_date_add_years(time_t date, int years) {
-    struct tm* timeinfo = localtime(&date);
-    if (!timeinfo) return date;
+    UtilsCivilDate civil;
+    if (!utils_date_civil(date, &civil)) return date;
     
-    timeinfo->tm_year += years;
+    civil.year += years;
     
-    int max_day = utils_date_days_in_month(timeinfo->tm_year + 1900, timeinfo->tm_mon + 1);
-    if (timeinfo->tm_mday > max_day) {
-        timeinfo->tm_mday = max_day;
+    int max_day = utils_date_days_in_month(civil.year, civil.month);
+    if (civil.day > max_day) {
+        civil.day = max_day;
     }
     
-    return mktime(timeinfo);
+    return utils_date_from_civil(&civil);
 }
 
 int utils_date_is_weekend(time_t date) {
@@ -471,13 +601,17 @@ int utils_date_is_holiday(time_t date) {
 char* utils_date_format(time_t date, const char* format) {
     if (!format) return NULL;
     
-    struct tm* timeinfo = localtime(&date);
-    if (!timeinfo) return NULL;
+    struct tm timeinfo;
+#if defined(_WIN32) || defined(_WIN64)
+    if (localtime_s(&timeinfo, &date) != 0) return NULL;
+#else
+    if (localtime_r(&date, &timeinfo) == NULL) return NULL;
+#endif
     
     char* buffer = (char*)malloc(UTILS_MAX_STRING_LENGTH);
     if (!buffer) return NULL;
     
-    strftime(buffer, UTILS_MAX_STRING_LENGTH, format, timeinfo);
+    strftime(buffer, UTILS_MAX_STRING_LENGTH, format, &timeinfo);
     return buffer;
 }
 
@@ -742,6 +876,80 @@ int utils_file_append(const char* filename, const char* content) {
     return written == len;
 }
 
+int utils_file_map(const char* filename, UtilsMappedFile* mapped) {
+    if (!filename || !mapped) return 0;
+    mapped->data = NULL;
+    mapped->size = 0;
+    mapped->is_mapped = 0;
+
+#if defined(_WIN32) || defined(_WIN64)
+    // No mmap here: fall back to a single read into a heap buffer
+    FILE* file = fopen(filename, "rb");
+    if (!file) return 0;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < 0) {
+        fclose(file);
+        return 0;
+    }
+    if (size > 0) {
+        char* buffer = (char*)malloc((size_t)size);
+        if (!buffer) {
+            fclose(file);
+            return 0;
+        }
+        if (fread(buffer, 1, (size_t)size, file) != (size_t)size) {
+            free(buffer);
+            fclose(file);
+            return 0;
+        }
+        mapped->data = buffer;
+        mapped->size = (size_t)size;
+    }
+    fclose(file);
+    return 1;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return 0;
+    }
+    // An empty file cannot be mapped but is still a valid, empty view
+    if (st.st_size > 0) {
+        void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return 0;
+        }
+        madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+        mapped->data = (const char*)data;
+        mapped->size = (size_t)st.st_size;
+        mapped->is_mapped = 1;
+    }
+    close(fd);
+    return 1;
+#endif
+}
+
+void utils_file_unmap(UtilsMappedFile* mapped) {
+    if (!mapped || !mapped->data) return;
+#if defined(_WIN32) || defined(_WIN64)
+    free((void*)mapped->data);
+#else
+    if (mapped->is_mapped) {
+        munmap((void*)mapped->data, mapped->size);
+    } else {
+        free((void*)mapped->data);
+    }
+#endif
+    mapped->data = NULL;
+    mapped->size = 0;
+    mapped->is_mapped = 0;
+}
+
 // ============================================================================
 // MEMORY UTILITIES
 // ============================================================================
@@ -1232,6 +1440,25 @@ unsigned long utils_hash_combine(unsigned long hash1, unsigned long hash2) {
     return hash1 ^ (hash2 + 0x9e3779b9 + (hash1 << 6) + (hash1 >> 2));
 }
 
+// Adler-32 checksum (as in zlib); start with adler = 1 and chain calls
+unsigned int utils_hash_adler32(unsigned int adler, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    unsigned long a = adler & 0xffff;
+    unsigned long b = (adler >> 16) & 0xffff;
+    while (size > 0) {
+        // 5552 is the largest block that cannot overflow before the modulo
+        size_t block = size < 5552 ? size : 5552;
+        size -= block;
+        while (block--) {
+            a += *bytes++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (unsigned int)((b << 16) | a);
+}
+
 // ============================================================================
 // RANDOM UTILITIES
 // ============================================================================
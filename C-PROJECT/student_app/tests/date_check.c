@@ -0,0 +1,106 @@
+// Checks utils_date_civil against localtime_r in several time zones, from
+// several threads at once, so the per-thread offset cache is exercised the
+// way the attendance workers use it. POSIX only (setenv, pthreads).
+//
+//   cc -std=gnu11 -Iinclude tests/date_check.c src/utils.c -lpthread -lm
+//   ./a.out
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "utils.h"
+
+#define DATE_CHECK_THREADS 4
+#define DATE_CHECK_SAMPLES 200000
+
+static const char* date_check_zones[] = {
+    "UTC",
+    "America/New_York",
+    "Europe/Paris",
+    "Australia/Lord_Howe",   // Half-hour DST shift
+    "Asia/Kolkata",          // Half-hour offset, no DST
+};
+
+typedef struct {
+    unsigned int seed;
+    int failures;
+} DateCheckWorker;
+
+static unsigned int date_check_next(unsigned int* state) {
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 1;
+}
+
+static int date_check_one(time_t t) {
+    struct tm expected;
+    UtilsCivilDate civil;
+    if (localtime_r(&t, &expected) == NULL) {
+        return 1;
+    }
+    if (!utils_date_civil(t, &civil)) {
+        printf("  %lld: utils_date_civil failed\n", (long long)t);
+        return 0;
+    }
+    if (civil.year != expected.tm_year + 1900 || civil.month != expected.tm_mon + 1 ||
+        civil.day != expected.tm_mday || civil.hour != expected.tm_hour ||
+        civil.minute != expected.tm_min || civil.second != expected.tm_sec ||
+        civil.day_of_week != expected.tm_wday || civil.day_of_year != expected.tm_yday + 1) {
+        printf("  %lld: got %04d-%02d-%02d %02d:%02d:%02d, localtime says %04d-%02d-%02d %02d:%02d:%02d\n",
+               (long long)t, civil.year, civil.month, civil.day, civil.hour, civil.minute, civil.second,
+               expected.tm_year + 1900, expected.tm_mon + 1, expected.tm_mday,
+               expected.tm_hour, expected.tm_min, expected.tm_sec);
+        return 0;
+    }
+    return 1;
+}
+
+static void* date_check_worker(void* arg) {
+    DateCheckWorker* worker = (DateCheckWorker*)arg;
+    unsigned int state = worker->seed;
+    // 1960 to 2040, with runs of neighbouring seconds to hit the cache
+    time_t base = (time_t)-315619200;
+    long long span = 2524608000LL + 315619200LL;
+    for (int i = 0; i < DATE_CHECK_SAMPLES; i++) {
+        long long pick = ((long long)date_check_next(&state) << 16 ^ date_check_next(&state)) % span;
+        time_t t = base + (time_t)pick;
+        for (int step = 0; step < 4; step++) {
+            if (!date_check_one(t + step * 1799) && ++worker->failures > 10) {
+                return NULL;
+            }
+        }
+    }
+    // Every quarter hour of 2024, across both DST switches
+    for (time_t t = 1704067200; t < 1735689600; t += 900) {
+        if (!date_check_one(t) && ++worker->failures > 10) {
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+int main(void) {
+    int failures = 0;
+    size_t zone_count = sizeof(date_check_zones) / sizeof(date_check_zones[0]);
+    for (size_t z = 0; z < zone_count; z++) {
+        // Fresh threads per zone: the offset cache is per thread and assumes
+        // the zone does not change under it
+        setenv("TZ", date_check_zones[z], 1);
+        tzset();
+        pthread_t threads[DATE_CHECK_THREADS];
+        DateCheckWorker workers[DATE_CHECK_THREADS];
+        for (int i = 0; i < DATE_CHECK_THREADS; i++) {
+            workers[i].seed = (unsigned int)(z * 131 + i * 7919 + 1);
+            workers[i].failures = 0;
+            pthread_create(&threads[i], NULL, date_check_worker, &workers[i]);
+        }
+        int zone_failures = 0;
+        for (int i = 0; i < DATE_CHECK_THREADS; i++) {
+            pthread_join(threads[i], NULL);
+            zone_failures += workers[i].failures;
+        }
+        printf("%-20s %s\n", date_check_zones[z], zone_failures == 0 ? "ok" : "FAILED");
+        failures += zone_failures;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+// Checks sort_top_k_indices and sort_bottom_k_indices against a stable
+// descending sort of every position, on random inputs with and without
+// ties, for k from 0 to past the end.
+//
+//   cc -std=gnu11 -Iinclude tests/topk_check.c src/sort.c
+//   ./a.out
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sort.h"
+
+#define TOPK_CHECK_INPUTS 2000
+#define TOPK_CHECK_MAX_COUNT 300
+
+static unsigned int topk_check_state = 12345u;
+
+static unsigned int topk_check_next(void) {
+    topk_check_state = topk_check_state * 1103515245u + 12345u;
+    return topk_check_state >> 1;
+}
+
+static const unsigned int* topk_check_keys;
+
+// Largest key first; equal keys keep their positions in order
+static int topk_check_compare(const void* a, const void* b) {
+    int left = *(const int*)a;
+    int right = *(const int*)b;
+    if (topk_check_keys[left] != topk_check_keys[right]) {
+        return topk_check_keys[left] > topk_check_keys[right] ? -1 : 1;
+    }
+    return left - right;
+}
+
+static int topk_check_input(int input, const unsigned int* keys, int count, int k) {
+    int sorted[TOPK_CHECK_MAX_COUNT];
+    int picked[TOPK_CHECK_MAX_COUNT + 8];
+    for (int i = 0; i < count; i++) {
+        sorted[i] = i;
+    }
+    topk_check_keys = keys;
+    qsort(sorted, (size_t)count, sizeof(int), topk_check_compare);
+    int expected = k < count ? k : count;
+
+    int got = sort_top_k_indices(keys, count, k, picked);
+    if (got != expected || memcmp(picked, sorted, sizeof(int) * (size_t)expected) != 0) {
+        printf("input %d (count %d, k %d): top-k differs from the stable sort\n", input, count, k);
+        return 0;
+    }
+    got = sort_bottom_k_indices(keys, count, k, picked);
+    if (got != expected) {
+        printf("input %d (count %d, k %d): bottom-k returned %d\n", input, count, k, got);
+        return 0;
+    }
+    for (int i = 0; i < expected; i++) {
+        if (picked[i] != sorted[count - 1 - i]) {
+            printf("input %d (count %d, k %d): bottom-k differs from the stable sort\n", input, count, k);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main(void) {
+    unsigned int keys[TOPK_CHECK_MAX_COUNT];
+    int failures = 0;
+    for (int input = 0; input < TOPK_CHECK_INPUTS; input++) {
+        int count = (int)(topk_check_next() % (TOPK_CHECK_MAX_COUNT + 1));
+        int k = (int)(topk_check_next() % (unsigned int)(count + 8));
+        int shape = input % 4;
+        for (int i = 0; i < count; i++) {
+            if (shape == 0) {
+                keys[i] = topk_check_next() ^ (topk_check_next() << 16);
+            } else if (shape == 1) {
+                keys[i] = topk_check_next() % 4;            // Mostly ties
+            } else if (shape == 2) {
+                // GPAs on the 0-4 scale, as the stats ranking uses them
+                keys[i] = sort_key_from_float((float)(topk_check_next() % 41) / 10.0f);
+            } else {
+                keys[i] = sort_key_from_int((int)(topk_check_next() % 200) - 100);
+            }
+        }
+        if (!topk_check_input(input, keys, count, k) && ++failures > 10) {
+            break;
+        }
+    }
+    printf("%d inputs, %s\n", TOPK_CHECK_INPUTS, failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}